@@ -1,5 +1,8 @@
 #include <algorithm>
+#include <atomic>
 #include <cstdio>
+#include <fstream>
+#include <memory>
 #include <list>
 #include <iostream>
 #include <iomanip>
@@ -31,6 +34,8 @@
 #include <AMReX_StateData.H>
 #include <AMReX_PlotFileUtil.H>
 #include <AMReX_Print.H>
+#include <AMReX_BackgroundThread.H>
+#include <AMReX_FileSystem.H>
 
 #ifdef BL_LAZY
 #include <AMReX_Lazy.H>
@@ -78,6 +83,7 @@ namespace
     int  plot_nfiles;
     int  mffile_nstreams;
     int  probinit_natonce;
+    int  restart_file_order_reads;
     bool plot_files_output;
     int  checkpoint_nfiles;
     int  regrid_on_restart;
@@ -90,6 +96,253 @@ namespace
     bool prereadFAHeaders;
     VisMF::Header::Version plot_headerversion(VisMF::Header::Version_v1);
     VisMF::Header::Version checkpoint_headerversion(VisMF::Header::Version_v1);
+    int  checkpoint_delta_int;
+    int  num_delta_checkpoints;
+    std::string checkpoint_stage_dir;
+    Vector<Real> small_plot_error_bounds;
+
+    //
+    // With AsyncOut, the plotfile and checkpoint headers are built in
+    // memory and written by the background thread after the data.
+    //
+    void AsyncWriteHeader (std::string const& file_name, std::string&& contents)
+    {
+        auto hdr = std::make_shared<std::string>(std::move(contents));
+        AsyncOut::Submit([=] ()
+        {
+            std::ofstream ofs(file_name.c_str(), std::ios::out | std::ios::trunc |
+                                                 std::ios::binary);
+            if ( ! ofs.good()) {
+                amrex::FileOpenFailed(file_name);
+            }
+            ofs.write(hdr->data(), hdr->size());
+            if ( ! ofs.good()) {
+                amrex::Error("AsyncWriteHeader: failed to write " + file_name);
+            }
+        });
+    }
+
+    //
+    // Checkpoints written to amr.checkpoint_stage_dir are copied to their
+    // final directory by a background thread.  The staging directory may be
+    // node-local, in which case the ranks of a node share the copying of
+    // the node's files.  Otherwise all ranks share it.  The copy is moved
+    // into place at the first coarse step after every rank has finished.
+    // Errors on the background thread are kept in drain_error and reported
+    // by FinishDrain on the main thread.
+    //
+    bool stage_dir_checked = false;
+    bool stage_dir_shared;
+    int  stage_rank;
+    int  stage_nranks;
+    std::string draining_ckfile;
+    std::string drain_error;
+    std::atomic<bool> drain_done(false);
+    std::unique_ptr<BackgroundThread> drain_thread;
+
+    std::string StagePath (std::string const& ckfile)
+    {
+        return checkpoint_stage_dir + "/" + ckfile;
+    }
+
+    void CheckStageDir ()
+    {
+        if (stage_dir_checked) return;
+        stage_dir_checked = true;
+
+        if ( ! amrex::UtilCreateDirectory(checkpoint_stage_dir, 0755)) {
+            amrex::CreateDirectoryFailed(checkpoint_stage_dir);
+        }
+        //
+        // The directory is shared if every rank sees a file made by the IO rank.
+        //
+        const int myProc = ParallelDescriptor::MyProc();
+        const int ioProc = ParallelDescriptor::IOProcessorNumber();
+        std::string marker;
+        if (ParallelDescriptor::IOProcessor()) {
+            marker = checkpoint_stage_dir + "/.stage_" + amrex::UniqueString();
+            std::ofstream ofs(marker.c_str());
+        }
+        amrex::BroadcastString(marker, myProc, ioProc, ParallelDescriptor::Communicator());
+        ParallelDescriptor::Barrier("Amr::CheckStageDir");
+        stage_dir_shared = amrex::FileExists(marker);
+        ParallelDescriptor::ReduceBoolAnd(stage_dir_shared);
+        if (ParallelDescriptor::IOProcessor()) {
+            FileSystem::Remove(marker);
+        }
+
+        stage_rank = myProc;
+        stage_nranks = ParallelDescriptor::NProcs();
+#ifdef BL_USE_MPI
+        if ( ! stage_dir_shared) {
+            MPI_Comm nodeComm;
+            BL_MPI_REQUIRE( MPI_Comm_split_type(ParallelDescriptor::Communicator(),
+                                                MPI_COMM_TYPE_SHARED, myProc,
+                                                MPI_INFO_NULL, &nodeComm) );
+            MPI_Comm_rank(nodeComm, &stage_rank);
+            MPI_Comm_size(nodeComm, &stage_nranks);
+            MPI_Comm_free(&nodeComm);
+        }
+#endif
+    }
+
+    // Returns an error message, or an empty string on success.
+    std::string CopyFile (std::string const& src, std::string const& dst)
+    {
+        std::ifstream ifs(src.c_str(), std::ios::in | std::ios::binary);
+        if ( ! ifs.good()) {
+            return "unable to open " + src;
+        }
+        std::ofstream ofs(dst.c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
+        if ( ! ofs.good()) {
+            return "unable to open " + dst;
+        }
+        if (ifs.peek() != std::ifstream::traits_type::eof()) {
+            ofs << ifs.rdbuf();
+        }
+        ofs.close();
+        if (ifs.bad() || ofs.fail()) {
+            return "failed to copy " + src + " to " + dst;
+        }
+        return std::string();
+    }
+
+    //
+    // Start copying the staged checkpoint ckfile to ckfile.temp.  Collective.
+    //
+    void StartDrain (std::string const& ckfile)
+    {
+        const std::string src = StagePath(ckfile);
+        const std::string dst = ckfile + ".temp";
+
+        amrex::UtilCreateCleanDirectory(dst, true);
+
+        std::vector<std::string> files = FileSystem::ListFiles(src);
+        std::sort(files.begin(), files.end());
+        std::vector<std::string> myfiles;
+        for (int i = stage_rank; i < static_cast<int>(files.size()); i += stage_nranks) {
+            myfiles.push_back(files[i]);
+        }
+
+        if ( ! drain_thread) {
+            drain_thread.reset(new BackgroundThread());
+        }
+        drain_error.clear();
+        drain_done = false;
+        drain_thread->Submit([=] ()
+        {
+            std::string err;
+            for (auto const& f : myfiles) {
+                const std::string dstfile = dst + "/" + f;
+                const std::string dstdir = dstfile.substr(0, dstfile.rfind('/'));
+                if ( ! amrex::UtilCreateDirectory(dstdir, 0755)) {
+                    err = "unable to create directory " + dstdir;
+                } else {
+                    err = CopyFile(src + "/" + f, dstfile);
+                }
+                if ( ! err.empty()) break;
+            }
+            drain_error = err;
+            drain_done = true;
+        });
+
+        draining_ckfile = ckfile;
+    }
+
+    //
+    // Wait for the copying to finish, move ckfile.temp to ckfile and
+    // remove the staged checkpoint.  If any rank failed to copy its files
+    // the staged checkpoint is kept and the run stops.  Collective.
+    //
+    void FinishDrain ()
+    {
+        if (draining_ckfile.empty()) return;
+
+        drain_thread->Finish();
+
+        bool failed = ! drain_error.empty();
+        ParallelDescriptor::ReduceBoolOr(failed);
+        if (failed) {
+            if ( ! drain_error.empty()) {
+                amrex::AllPrint() << "Amr: rank " << ParallelDescriptor::MyProc()
+                                  << ": " << drain_error << '\n';
+            }
+            ParallelDescriptor::Barrier("Amr::FinishDrain::error");
+            amrex::Error("Amr: copying staged checkpoint " + StagePath(draining_ckfile) +
+                         " to " + draining_ckfile + ".temp failed; the staged copy is kept");
+        }
+
+        ParallelDescriptor::Barrier("Amr::FinishDrain");
+        if (ParallelDescriptor::IOProcessor()) {
+            amrex::UtilRenameDirectoryToOld(draining_ckfile, false);
+            std::rename((draining_ckfile + ".temp").c_str(), draining_ckfile.c_str());
+        }
+        if (stage_rank == 0) {
+            FileSystem::RemoveAll(StagePath(draining_ckfile));
+        }
+        ParallelDescriptor::Barrier("Amr::FinishDrain::end");
+
+        draining_ckfile.clear();
+    }
+
+    //
+    // Finish the drain if every rank is done copying.  Collective.
+    //
+    void PollDrain ()
+    {
+        if (draining_ckfile.empty()) return;
+
+        bool done = drain_done;
+        ParallelDescriptor::ReduceBoolAnd(done);
+        if (done) {
+            FinishDrain();
+        }
+    }
+
+    //
+    // Complete the drain of ckfile if a run stopped before it finished.
+    // It is an error if ckfile was never moved into place and the staged
+    // copy is missing on some nodes, e.g. because node-local storage did
+    // not survive the job.
+    //
+    void RecoverStaged (std::string ckfile)
+    {
+        CheckStageDir();
+
+        while (ckfile.size() > 1 && ckfile.back() == '/') {
+            ckfile.pop_back();
+        }
+
+        bool staged = amrex::FileExists(StagePath(ckfile));
+        bool staged_all = staged;
+        ParallelDescriptor::ReduceBoolOr(staged);
+        ParallelDescriptor::ReduceBoolAnd(staged_all);
+
+        bool complete = amrex::FileExists(ckfile + "/Header");
+        ParallelDescriptor::ReduceBoolOr(complete);
+        bool draining = amrex::FileExists(ckfile + ".temp");
+        ParallelDescriptor::ReduceBoolOr(draining);
+
+        if (complete) {
+            if (staged) {
+                if (stage_rank == 0 && amrex::FileExists(StagePath(ckfile))) {
+                    FileSystem::RemoveAll(StagePath(ckfile));
+                }
+                ParallelDescriptor::Barrier("Amr::RecoverStaged");
+            }
+        } else if ( ! staged_all) {
+            if (staged || draining) {
+                amrex::Error("Amr: checkpoint " + ckfile + " was not fully copied from " +
+                             StagePath(ckfile) + " and the staged copy is missing on " +
+                             (staged ? "some nodes" : "all nodes"));
+            }
+        } else {
+            amrex::Print() << "Amr: copying staged checkpoint " << StagePath(ckfile)
+                           << " to " << ckfile << '\n';
+            StartDrain(ckfile);
+            FinishDrain();
+        }
+    }
 }
 
 
@@ -112,6 +365,7 @@ Amr::Initialize ()
     plot_nfiles              = 64;
     mffile_nstreams          = 1;
     probinit_natonce         = 512;
+    restart_file_order_reads = 0;
     plot_files_output        = true;
     checkpoint_nfiles        = 64;
     regrid_on_restart        = 0;
@@ -125,6 +379,10 @@ Amr::Initialize ()
     prereadFAHeaders         = true;
     plot_headerversion       = VisMF::Header::Version_v1;
     checkpoint_headerversion = VisMF::Header::Version_v1;
+    checkpoint_delta_int     = 0;
+    num_delta_checkpoints    = 0;
+    checkpoint_stage_dir.clear();
+    small_plot_error_bounds.clear();
 #ifdef BL_USE_SENSEI_INSITU
     insitu_bridge            = nullptr;
 #endif
@@ -143,6 +401,9 @@ Amr::Finalize ()
     Amr::initial_ba.clear();
     Amr::finalizeInSitu();
 
+    drain_thread.reset();
+    stage_dir_checked = false;
+
     initialized = false;
 }
 
@@ -263,6 +524,7 @@ Amr::InitAmr ()
 
     pp.query("mffile_nstreams", mffile_nstreams);
     pp.query("probinit_natonce", probinit_natonce);
+    pp.query("restart_file_order_reads", restart_file_order_reads);
 
     probinit_natonce = std::max(1, std::min(ParallelDescriptor::NProcs(), probinit_natonce));
 
@@ -733,6 +995,8 @@ Amr::deleteDeriveSmallPlotVar (const std::string& name)
 
 Amr::~Amr ()
 {
+    FinishDrain();
+
     levelbld->variableCleanUp();
 
     Amr::Finalize();
@@ -925,6 +1189,11 @@ Amr::writePlotFileDoit (std::string const& pltfile, bool regular)
     VisMF::SetNOutFiles(plot_nfiles);
     VisMF::Header::Version currentVersion(VisMF::GetHeaderVersion());
     VisMF::SetHeaderVersion(plot_headerversion);
+    const Vector<Real> currentErrorBounds(VisMF::GetErrorBounds());
+    if ( ! regular && ! small_plot_error_bounds.empty()) {
+        VisMF::SetHeaderVersion(VisMF::Header::LossyCompressed_v1);
+        VisMF::SetErrorBounds(small_plot_error_bounds);
+    }
 
     amrex::StreamRetry sretry(pltfile, abort_on_stream_retry_failure,
                               stream_max_tries);
@@ -956,9 +1225,12 @@ Amr::writePlotFileDoit (std::string const& pltfile, bool regular)
 
         VisMF::IO_Buffer io_buffer(VisMF::GetIOBufferSize());
 
-        std::ofstream HeaderFile;
+        std::ofstream HeaderFileStream;
+        std::ostringstream HeaderStringStream;
+        std::ostream& HeaderFile = (AsyncOut::UseAsyncOut())
+            ? static_cast<std::ostream&>(HeaderStringStream) : HeaderFileStream;
 
-        HeaderFile.rdbuf()->pubsetbuf(io_buffer.dataPtr(), io_buffer.size());
+        HeaderFileStream.rdbuf()->pubsetbuf(io_buffer.dataPtr(), io_buffer.size());
 
         int old_prec(0);
 
@@ -966,10 +1238,12 @@ Amr::writePlotFileDoit (std::string const& pltfile, bool regular)
             //
             // Only the IOProcessor() writes to the header file.
             //
-            HeaderFile.open(HeaderFileName.c_str(), std::ios::out | std::ios::trunc |
-                            std::ios::binary);
-            if ( ! HeaderFile.good()) {
-                amrex::FileOpenFailed(HeaderFileName);
+            if ( ! AsyncOut::UseAsyncOut()) {
+                HeaderFileStream.open(HeaderFileName.c_str(), std::ios::out | std::ios::trunc |
+                                      std::ios::binary);
+                if ( ! HeaderFileStream.good()) {
+                    amrex::FileOpenFailed(HeaderFileName);
+                }
             }
             old_prec = HeaderFile.precision(15);
         }
@@ -999,6 +1273,9 @@ Amr::writePlotFileDoit (std::string const& pltfile, bool regular)
                     amrex::Error("Amr::writeSmallPlotFile() failed");
                 }
             }
+            if (AsyncOut::UseAsyncOut()) {
+                AsyncWriteHeader(HeaderFileName, HeaderStringStream.str());
+            }
         }
 
         if (regular) {
@@ -1033,6 +1310,7 @@ Amr::writePlotFileDoit (std::string const& pltfile, bool regular)
     }  // end while
 
     VisMF::SetHeaderVersion(currentVersion);
+    VisMF::SetErrorBounds(currentErrorBounds);
 }
 
 void
@@ -1363,7 +1641,19 @@ Amr::restart (const std::string& filename)
 
     auto dRestartTime0 = amrex::second();
 
+    if ( ! checkpoint_stage_dir.empty()) {
+        RecoverStaged(filename);
+    }
+
     VisMF::SetMFFileInStreams(mffile_nstreams);
+    //
+    // Read the checkpoint in file order, so that the files are read
+    // sequentially whatever the number of processes that wrote them.
+    //
+    const bool useSynchronousReads = VisMF::GetUseSynchronousReads();
+    if (restart_file_order_reads) {
+        VisMF::SetUseSynchronousReads(true);
+    }
 
     if (verbose > 0) {
 	amrex::Print() << "restarting calculation from file: " << filename << "\n";
@@ -1660,6 +1950,8 @@ Amr::restart (const std::string& filename)
         }
     }
 
+    VisMF::SetUseSynchronousReads(useSynchronousReads);
+
     if (verbose > 0)
     {
         auto dRestartTime = amrex::second() - dRestartTime0;
@@ -1681,7 +1973,21 @@ Amr::checkPoint ()
     BL_PROFILE_REGION_START("Amr::checkPoint()");
     BL_PROFILE("Amr::checkPoint()");
 
-    VisMF::SetNOutFiles(checkpoint_nfiles);
+    // ---- wait for the previous staged checkpoint
+    FinishDrain();
+
+    //
+    // With a staging directory, the checkpoint is written there and copied
+    // to ckfile in the background.  A node-local staging directory needs a
+    // file per process.
+    //
+    const bool staged = ! checkpoint_stage_dir.empty() && ! AsyncOut::UseAsyncOut();
+    if (staged) {
+        CheckStageDir();
+    }
+
+    VisMF::SetNOutFiles((staged && ! stage_dir_shared) ? ParallelDescriptor::NProcs()
+                                                       : checkpoint_nfiles);
     //
     // In checkpoint files always write out FABs in NATIVE format.
     //
@@ -1704,11 +2010,20 @@ Amr::checkPoint ()
         runlog << "CHECKPOINT: file = " << ckfile << '\n';
     }
 
-  amrex::StreamRetry sretry(ckfile, abort_on_stream_retry_failure,
-                             stream_max_tries);
+  amrex::StreamRetry sretry(staged ? StagePath(ckfile) : ckfile,
+                            abort_on_stream_retry_failure, stream_max_tries);
 
   // For AsyncOut, we need to turn off stream retry and write to ckfile directly.
-  const std::string ckfileTemp = (AsyncOut::UseAsyncOut()) ? ckfile : (ckfile + ".temp");
+  const std::string ckfileTemp = (AsyncOut::UseAsyncOut()) ? ckfile
+                               : (staged ? StagePath(ckfile + ".temp") : (ckfile + ".temp"));
+
+  if (checkpoint_delta_int > 0 && ! AsyncOut::UseAsyncOut() && ! staged) {
+      const bool delta = num_delta_checkpoints < checkpoint_delta_int;
+      num_delta_checkpoints = delta ? num_delta_checkpoints + 1 : 0;
+      StateData::SetDeltaCheckPoint(ckfile, delta);
+  } else {
+      StateData::SetDeltaCheckPoint(std::string(), false);
+  }
 
   while(sretry.TryFileOutput()) {
 
@@ -1722,7 +2037,25 @@ Amr::checkPoint ()
     //  it to a bad suffix if there were stream errors.
     //
 
-    if (precreateDirectories) {    // ---- make all directories at once
+    if (staged) {    // ---- the staging directory may be node-local, every process makes them
+      if (stage_rank == 0 && amrex::FileExists(ckfileTemp)) {
+        FileSystem::RemoveAll(ckfileTemp);
+      }
+      ParallelDescriptor::Barrier("Amr::checkPoint::stage");
+      if ( ! amrex::UtilCreateDirectory(ckfileTemp, 0755)) {
+        amrex::CreateDirectoryFailed(ckfileTemp);
+      }
+      for (int i(0); i <= finest_level; ++i)
+      {
+        amr_level[i]->CreateLevelDirectory(ckfileTemp);
+        std::string LevelDir, FullPath;
+        amr_level[i]->LevelDirectoryNames(ckfileTemp, LevelDir, FullPath);
+        if ( ! amrex::UtilCreateDirectory(FullPath, 0755)) {
+          amrex::CreateDirectoryFailed(FullPath);
+        }
+      }
+      ParallelDescriptor::Barrier("Amr::checkPoint::stage::dirs");
+    } else if (precreateDirectories) {    // ---- make all directories at once
       amrex::UtilRenameDirectoryToOld(ckfile, false);      // dont call barrier
       amrex::UtilCreateCleanDirectory(ckfileTemp, false);  // dont call barrier
       for (int i(0); i <= finest_level; ++i) 
@@ -1739,9 +2072,12 @@ Amr::checkPoint ()
 
     VisMF::IO_Buffer io_buffer(VisMF::GetIOBufferSize());
 
-    std::ofstream HeaderFile;
+    std::ofstream HeaderFileStream;
+    std::ostringstream HeaderStringStream;
+    std::ostream& HeaderFile = (AsyncOut::UseAsyncOut())
+        ? static_cast<std::ostream&>(HeaderStringStream) : HeaderFileStream;
 
-    HeaderFile.rdbuf()->pubsetbuf(io_buffer.dataPtr(), io_buffer.size());
+    HeaderFileStream.rdbuf()->pubsetbuf(io_buffer.dataPtr(), io_buffer.size());
 
     int old_prec = 0;
 
@@ -1750,12 +2086,13 @@ Amr::checkPoint ()
         //
         // Only the IOProcessor() writes to the header file.
         //
-        HeaderFile.open(HeaderFileName.c_str(), std::ios::out | std::ios::trunc |
-	                                        std::ios::binary);
-
-        if ( ! HeaderFile.good()) {
-            amrex::FileOpenFailed(HeaderFileName);
-	}
+        if ( ! AsyncOut::UseAsyncOut()) {
+            HeaderFileStream.open(HeaderFileName.c_str(), std::ios::out | std::ios::trunc |
+                                                          std::ios::binary);
+            if ( ! HeaderFileStream.good()) {
+                amrex::FileOpenFailed(HeaderFileName);
+            }
+        }
 
         old_prec = HeaderFile.precision(17);
 
@@ -1799,16 +2136,24 @@ Amr::checkPoint ()
 	const Vector<std::string> &FAHeaderNames = StateData::FabArrayHeaderNames();
 	if(FAHeaderNames.size() > 0) {
           std::string FAHeaderFilesName = ckfileTemp + "/FabArrayHeaders.txt";
-          std::ofstream FAHeaderFile(FAHeaderFilesName.c_str(),
-	                             std::ios::out | std::ios::trunc |
-	                             std::ios::binary);
-          if ( ! FAHeaderFile.good()) {
-              amrex::FileOpenFailed(FAHeaderFilesName);
-	  }
-
-	  for(int i(0); i < FAHeaderNames.size(); ++i) {
-	    FAHeaderFile << FAHeaderNames[i] << '\n';
-	  }
+          if (AsyncOut::UseAsyncOut()) {
+            std::string FAHeaders;
+            for(int i(0); i < FAHeaderNames.size(); ++i) {
+              FAHeaders += FAHeaderNames[i] + '\n';
+            }
+            AsyncWriteHeader(FAHeaderFilesName, std::move(FAHeaders));
+          } else {
+            std::ofstream FAHeaderFile(FAHeaderFilesName.c_str(),
+	                               std::ios::out | std::ios::trunc |
+	                               std::ios::binary);
+            if ( ! FAHeaderFile.good()) {
+                amrex::FileOpenFailed(FAHeaderFilesName);
+	    }
+
+	    for(int i(0); i < FAHeaderNames.size(); ++i) {
+	      FAHeaderFile << FAHeaderNames[i] << '\n';
+	    }
+          }
 	}
     }
 
@@ -1818,6 +2163,10 @@ Amr::checkPoint ()
         if( ! HeaderFile.good()) {
             amrex::Error("Amr::checkpoint() failed");
 	}
+
+        if (AsyncOut::UseAsyncOut()) {
+            AsyncWriteHeader(HeaderFileName, HeaderStringStream.str());
+        }
     }
 
     last_checkpoint = level_steps[0];
@@ -1834,6 +2183,15 @@ Amr::checkPoint ()
 
     if (AsyncOut::UseAsyncOut()) {
         break;
+    } else if (staged) {
+        ParallelDescriptor::Barrier("Amr::checkPoint::end");
+        if (stage_rank == 0) {
+            if (amrex::FileExists(StagePath(ckfile))) {
+                FileSystem::RemoveAll(StagePath(ckfile));
+            }
+            std::rename(ckfileTemp.c_str(), StagePath(ckfile).c_str());
+        }
+        ParallelDescriptor::Barrier("Renaming staged checkPoint file.");
     } else {
         ParallelDescriptor::Barrier("Amr::checkPoint::end");
         if(ParallelDescriptor::IOProcessor()) {
@@ -1843,6 +2201,23 @@ Amr::checkPoint ()
     }
   }  // end while
 
+  //
+  // Copy the staged checkpoint unless stream retry gave up on it, in which
+  // case the IO processor has renamed its copy out of the way.
+  //
+  if (staged) {
+      bool good = amrex::FileExists(StagePath(ckfile));
+      ParallelDescriptor::ReduceBoolAnd(good);
+      if (good) {
+          StartDrain(ckfile);
+      } else {
+          if (stage_rank == 0 && amrex::FileExists(StagePath(ckfile))) {
+              FileSystem::RemoveAll(StagePath(ckfile));
+          }
+          ParallelDescriptor::Barrier("Amr::checkPoint::stage::bad");
+      }
+  }
+
   //
   // Restore the previous FAB format.
   //
@@ -2098,6 +2473,9 @@ Amr::coarseTimeStep (Real stop_time)
 
     amr_level[0]->postCoarseTimeStep(cumtime);
 
+    // ---- move a staged checkpoint into place once it is copied
+    PollDrain();
+
 
     if (verbose > 0)
     {
@@ -3210,6 +3588,10 @@ Amr::initPltAndChk ()
             amrex::Warning("Warning: both amr.small_plot_int and amr.small_plot_per are > 0.");
     }
 
+    // ---- bounds on the absolute error of the small plotfile data,
+    // ---- one for all components or one per component
+    pp.queryarr("small_plot_error_bounds", small_plot_error_bounds);
+
     write_plotfile_with_checkpoint = 1;
     pp.query("write_plotfile_with_checkpoint",write_plotfile_with_checkpoint);
 
@@ -3232,6 +3614,13 @@ Amr::initPltAndChk ()
     if(chvInt != checkpoint_headerversion) {
       checkpoint_headerversion = static_cast<VisMF::Header::Version> (chvInt);
     }
+
+    // ---- the number of delta checkpoints after each full one
+    pp.query("checkpoint_delta_int", checkpoint_delta_int);
+    num_delta_checkpoints = checkpoint_delta_int;  // ---- the first one is full
+
+    // ---- write checkpoints here first and copy them in the background
+    pp.query("checkpoint_stage_dir", checkpoint_stage_dir);
 }
 
 
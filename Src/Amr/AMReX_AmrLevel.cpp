@@ -356,7 +356,8 @@ AmrLevel::writePlotFile (const std::string& dir,
     std::string TheFullPath = FullPath;
     TheFullPath += BaseName;
     if (AsyncOut::UseAsyncOut()) {
-        VisMF::AsyncWrite(plotMF,TheFullPath);
+        // plotMF is not needed anymore, so its data can be handed over.
+        VisMF::AsyncWrite(std::move(plotMF),TheFullPath);
     } else {
         VisMF::Write(plotMF,TheFullPath,how,true);
     }
@@ -2,12 +2,14 @@
 #include <iostream>
 #include <limits>
 #include <algorithm>
+#include <cstring>
 
 #include <AMReX_RealBox.H>
 #include <AMReX_StateData.H>
 #include <AMReX_StateDescriptor.H>
 #include <AMReX_ParallelDescriptor.H>
 #include <AMReX_Utility.H>
+#include <AMReX_AsyncOut.H>
 
 #ifdef AMREX_USE_OMP
 #include <omp.h>
@@ -26,6 +28,37 @@ static constexpr int MFOLDDATA = 1;
 
 Vector<std::string> StateData::fabArrayHeaderNames;
 std::map<std::string, Vector<char> > *StateData::faHeaderMap;
+std::string StateData::checkPointDir;
+bool StateData::deltaCheckPoint = false;
+
+namespace {
+    // 64-bit hash of the bytes of a fab, including the ghost cells.
+    std::uint64_t FabHash (const FArrayBox& fab)
+    {
+        const std::size_t nbytes = fab.nBytes();
+        const char* p = reinterpret_cast<const char*>(fab.dataPtr());
+#ifdef AMREX_USE_GPU
+        Vector<char> h_data(nbytes);
+        Gpu::dtoh_memcpy(h_data.data(), p, nbytes);
+        p = h_data.data();
+#endif
+        auto rotl = [] (std::uint64_t x, int r) { return (x << r) | (x >> (64-r)); };
+        std::uint64_t h = 0x9e3779b97f4a7c15ULL ^ nbytes;
+        for (std::size_t i = 0; i < nbytes; i += 8) {
+            std::uint64_t w = 0;
+            std::memcpy(&w, p+i, std::min<std::size_t>(8, nbytes-i));
+            w *= 0x87c37b91114253d5ULL;
+            w = rotl(w, 31);
+            w *= 0x4cf5ad432745937fULL;
+            h ^= w;
+            h = rotl(h, 27) * 5 + 0x52dce729;
+        }
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        return h;
+    }
+}
 
 
 StateData::StateData () 
@@ -57,7 +90,8 @@ StateData::StateData (StateData&& rhs) noexcept
       old_time(rhs.old_time),
       new_data(std::move(rhs.new_data)),
       old_data(std::move(rhs.old_data)),
-      arena(rhs.arena)
+      arena(rhs.arena),
+      chk_base(std::move(rhs.chk_base))
 {   
 }
 
@@ -273,6 +307,7 @@ StateData::restartDoit (std::istream& is, const std::string& chkfile)
 	}
       }
 
+      VisMF::CheckDeltaBase(FullPathName);
       VisMF::Read(*whichMF, FullPathName, faHeader);
     }
 }
@@ -822,26 +857,62 @@ StateData::checkPoint (const std::string& name,
     if (desc->store_in_checkpoint())
     {
        BL_ASSERT(new_data);
-       std::string mf_fullpath_new(fullpathname + NewSuffix);
-       if (AsyncOut::UseAsyncOut()) {
-           VisMF::AsyncWrite(*new_data,mf_fullpath_new);
-       } else {
-           VisMF::Write(*new_data,mf_fullpath_new,how);
-       }
+       checkPointData(*new_data, MFNEWDATA, name + NewSuffix, fullpathname + NewSuffix, how);
 
        if (dump_old)
        {
            BL_ASSERT(old_data);
-           std::string mf_fullpath_old(fullpathname + OldSuffix);
-           if (AsyncOut::UseAsyncOut()) {
-               VisMF::AsyncWrite(*old_data,mf_fullpath_old);
-           } else {
-               VisMF::Write(*old_data,mf_fullpath_old,how);
-           }
+           checkPointData(*old_data, MFOLDDATA, name + OldSuffix, fullpathname + OldSuffix, how);
        }
     }
 }
 
+void
+StateData::checkPointData (const MultiFab& mf, int which, const std::string& name,
+                           const std::string& fullpathname, VisMF::How how)
+{
+    CheckPointBase& base = chk_base[which];
+
+    if (AsyncOut::UseAsyncOut()) {
+        base = CheckPointBase();
+        VisMF::AsyncWrite(mf,fullpathname);
+        return;
+    }
+
+    if (checkPointDir.empty()) {
+        base = CheckPointBase();
+        VisMF::Write(mf,fullpathname,how);
+        return;
+    }
+
+    Vector<std::uint64_t> hashes(mf.local_size());
+#ifdef AMREX_USE_OMP
+#pragma omp parallel for
+#endif
+    for (int li = 0; li < mf.local_size(); ++li) {
+        hashes[li] = FabHash(mf.atLocalIdx(li));
+    }
+
+    if (deltaCheckPoint && !base.name.empty() && base.grids == mf.boxArray()
+        && base.dmap == mf.DistributionMap())
+    {
+        Vector<int> changed(mf.size(), 0);
+        for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+            changed[mfi.index()] = hashes[mfi.LocalIndex()] != base.hashes[mfi.LocalIndex()];
+        }
+        ParallelDescriptor::ReduceIntMax(changed.dataPtr(), changed.size());
+        VisMF::WriteDelta(mf, fullpathname, base.name, changed, how);
+    }
+    else
+    {
+        VisMF::Write(mf,fullpathname,how);
+        base.name = checkPointDir + "/" + name;
+        base.grids = mf.boxArray();
+        base.dmap = mf.DistributionMap();
+        base.hashes = std::move(hashes);
+    }
+}
+
 void
 StateData::printTimeInterval (std::ostream &os) const
 {
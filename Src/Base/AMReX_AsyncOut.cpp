@@ -6,6 +6,9 @@
 #include <AMReX_Utility.H>
 #include <AMReX.H>
 
+#include <condition_variable>
+#include <mutex>
+
 namespace amrex {
 namespace AsyncOut {
 
@@ -19,8 +22,13 @@ int s_asyncout = true; // Have this on by default for DPC++ for now so that
 int s_asyncout = false;
 #endif
 int s_noutfiles = 64;
+Long s_max_staging_size = 0;
 MPI_Comm s_comm = MPI_COMM_NULL;
 
+Long s_staging_size = 0;
+std::mutex s_staging_mutex;
+std::condition_variable s_staging_cv;
+
 std::unique_ptr<BackgroundThread> s_thread;
 
 WriteInfo s_info;
@@ -34,6 +42,7 @@ void Initialize ()
     ParmParse pp("amrex");
     pp.query("async_out", s_asyncout);
     pp.query("async_out_nfiles", s_noutfiles);
+    pp.query("async_out_max_staging_size", s_max_staging_size);
 
     int nprocs = ParallelDescriptor::NProcs();
     s_noutfiles = std::min(s_noutfiles, nprocs);
@@ -112,6 +121,31 @@ void Finish ()
     s_thread->Finish();
 }
 
+void ReserveStaging (Long nbytes)
+{
+    std::unique_lock<std::mutex> lck(s_staging_mutex);
+    if (s_max_staging_size > 0) {
+        s_staging_cv.wait(lck, [=] () { return s_staging_size == 0 ||
+                                   s_staging_size + nbytes <= s_max_staging_size; });
+    }
+    s_staging_size += nbytes;
+}
+
+void ReleaseStaging (Long nbytes)
+{
+    {
+        std::lock_guard<std::mutex> lck(s_staging_mutex);
+        s_staging_size -= nbytes;
+    }
+    s_staging_cv.notify_all();
+}
+
+Long StagingSize ()
+{
+    std::lock_guard<std::mutex> lck(s_staging_mutex);
+    return s_staging_size;
+}
+
 void Wait ()
 {
 #ifdef AMREX_USE_MPI
@@ -0,0 +1,248 @@
+
+#include <AMReX_BoxIndex.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_Utility.H>
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <sstream>
+
+namespace amrex {
+
+namespace {
+    constexpr int leaf_size = 4;
+    constexpr std::int32_t byte_order_mark = 0x01020304;
+    const std::string box_index_version("BoxIndex_v1");
+
+    void writeBox (std::ostream& os, const Box& bx)
+    {
+        std::int32_t iv[2*AMREX_SPACEDIM];
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            iv[idim] = bx.smallEnd(idim);
+            iv[idim+AMREX_SPACEDIM] = bx.bigEnd(idim);
+        }
+        os.write(reinterpret_cast<const char*>(iv), sizeof(iv));
+    }
+
+    Box readBox (std::istream& is, IndexType typ)
+    {
+        std::int32_t iv[2*AMREX_SPACEDIM];
+        is.read(reinterpret_cast<char*>(iv), sizeof(iv));
+        return Box(IntVect(AMREX_D_DECL(iv[0],iv[1],iv[2])),
+                   IntVect(AMREX_D_DECL(iv[AMREX_SPACEDIM],iv[AMREX_SPACEDIM+1],iv[AMREX_SPACEDIM+2])),
+                   typ);
+    }
+}
+
+BoxIndex::BoxIndex (const BoxArray& ba, const Vector<std::string>& files,
+                    const Vector<Long>& offsets, int vers, int ncomp,
+                    const IntVect& ngrow, const RealDescriptor& rd)
+    : m_boxes(ba.size()),
+      m_offsets(offsets),
+      m_file_id(ba.size()),
+      m_vers(vers),
+      m_ncomp(ncomp),
+      m_ngrow(ngrow),
+      m_rd(rd)
+{
+    AMREX_ALWAYS_ASSERT(files.size() == ba.size() && offsets.size() == ba.size());
+
+    std::map<std::string,int> file_ids;
+    for (int i = 0, N = ba.size(); i < N; ++i) {
+        m_boxes[i] = ba[i];
+        auto r = file_ids.emplace(files[i], static_cast<int>(m_files.size()));
+        if (r.second) {
+            m_files.push_back(files[i]);
+        }
+        m_file_id[i] = r.first->second;
+    }
+
+    m_order.resize(m_boxes.size());
+    for (int i = 0, N = m_order.size(); i < N; ++i) {
+        m_order[i] = i;
+    }
+    if (!m_boxes.empty()) {
+        m_nodes.reserve(2*(m_boxes.size()/leaf_size+1));
+        build(0, m_boxes.size());
+    }
+}
+
+int
+BoxIndex::build (int begin, int end)
+{
+    Box bounds = m_boxes[m_order[begin]];
+    for (int i = begin+1; i < end; ++i) {
+        bounds.minBox(m_boxes[m_order[i]]);
+    }
+
+    const int inode = m_nodes.size();
+    m_nodes.push_back(Node{bounds, -1, -1, begin, end});
+
+    if (end - begin > leaf_size)
+    {
+        // Split at the median of the box centers along the longest side.
+        const int dir = bounds.longside();
+        auto first = m_order.begin();
+        auto const& boxes = m_boxes;
+        std::nth_element(first+begin, first+(begin+end)/2, first+end,
+                         [&] (int a, int b) {
+                             return boxes[a].smallEnd(dir) + boxes[a].bigEnd(dir)
+                                 <  boxes[b].smallEnd(dir) + boxes[b].bigEnd(dir);
+                         });
+        const int left = build(begin, (begin+end)/2);
+        const int right = build((begin+end)/2, end);
+        m_nodes[inode].left = left;
+        m_nodes[inode].right = right;
+    }
+
+    return inode;
+}
+
+Vector<int>
+BoxIndex::intersections (const Box& bx) const
+{
+    Vector<int> r;
+    if (m_nodes.empty()) return r;
+
+    Vector<int> stack{0};
+    while (!stack.empty())
+    {
+        const Node& node = m_nodes[stack.back()];
+        stack.pop_back();
+        if (!node.bounds.intersects(bx)) continue;
+        if (node.left < 0) {
+            for (int i = node.begin; i < node.end; ++i) {
+                if (m_boxes[m_order[i]].intersects(bx)) {
+                    r.push_back(m_order[i]);
+                }
+            }
+        } else {
+            stack.push_back(node.left);
+            stack.push_back(node.right);
+        }
+    }
+    std::sort(r.begin(), r.end());
+    return r;
+}
+
+void
+BoxIndex::write (const std::string& name) const
+{
+    std::ofstream ofs(name, std::ios::out | std::ios::trunc | std::ios::binary);
+    if (!ofs.good()) {
+        amrex::FileOpenFailed(name);
+    }
+
+    const IndexType typ = m_boxes.empty() ? IndexType::TheCellType() : m_boxes[0].ixType();
+
+    ofs << box_index_version << ' ' << AMREX_SPACEDIM << ' ' << sizeof(Long) << ' '
+        << typ.ixType() << ' ' << m_boxes.size() << ' ' << m_nodes.size() << ' '
+        << m_files.size() << '\n';
+    ofs << m_vers << ' ' << m_ncomp << ' ' << m_ngrow << '\n';
+    ofs << m_rd << '\n';
+    for (auto const& f : m_files) {
+        ofs << f << '\n';
+    }
+
+    ofs.write(reinterpret_cast<const char*>(&byte_order_mark), sizeof(byte_order_mark));
+    for (int i = 0, N = m_boxes.size(); i < N; ++i) {
+        writeBox(ofs, m_boxes[i]);
+        const std::int32_t fid = m_file_id[i];
+        ofs.write(reinterpret_cast<const char*>(&fid), sizeof(fid));
+        ofs.write(reinterpret_cast<const char*>(&m_offsets[i]), sizeof(Long));
+    }
+    for (auto const& node : m_nodes) {
+        writeBox(ofs, node.bounds);
+        const std::int32_t iv[4] = {node.left, node.right, node.begin, node.end};
+        ofs.write(reinterpret_cast<const char*>(iv), sizeof(iv));
+    }
+    for (int i : m_order) {
+        const std::int32_t ii = i;
+        ofs.write(reinterpret_cast<const char*>(&ii), sizeof(ii));
+    }
+
+    if (!ofs.good()) {
+        amrex::Abort("BoxIndex::write: failed to write " + name);
+    }
+}
+
+bool
+BoxIndex::read (const std::string& name)
+{
+    *this = BoxIndex();
+
+    Vector<char> buf;
+    ParallelDescriptor::ReadAndBcastFile(name, buf, false);
+    if (buf.empty()) return false;
+
+    std::istringstream is(std::string(buf.dataPtr(), buf.size()-1));
+
+    std::string version;
+    int spacedim = 0, nboxes = 0, nnodes = 0, nfiles = 0;
+    std::size_t long_size = 0;
+    IntVect typ;
+    is >> version >> spacedim >> long_size >> typ >> nboxes >> nnodes >> nfiles;
+    is.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    if (is.fail() || version != box_index_version || spacedim != AMREX_SPACEDIM ||
+        long_size != sizeof(Long)) {
+        return false;
+    }
+
+    is >> m_vers >> m_ncomp >> m_ngrow >> m_rd;
+    is.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    if (is.fail()) {
+        *this = BoxIndex();
+        return false;
+    }
+
+    m_files.resize(nfiles);
+    for (auto& f : m_files) {
+        std::getline(is, f);
+    }
+
+    std::int32_t bom = 0;
+    is.read(reinterpret_cast<char*>(&bom), sizeof(bom));
+    if (bom != byte_order_mark) {
+        *this = BoxIndex();
+        return false;
+    }
+
+    const IndexType ixtyp(typ);
+    m_boxes.resize(nboxes);
+    m_file_id.resize(nboxes);
+    m_offsets.resize(nboxes);
+    for (int i = 0; i < nboxes; ++i) {
+        m_boxes[i] = readBox(is, ixtyp);
+        std::int32_t fid;
+        is.read(reinterpret_cast<char*>(&fid), sizeof(fid));
+        m_file_id[i] = fid;
+        is.read(reinterpret_cast<char*>(&m_offsets[i]), sizeof(Long));
+    }
+    m_nodes.resize(nnodes);
+    for (auto& node : m_nodes) {
+        node.bounds = readBox(is, ixtyp);
+        std::int32_t iv[4];
+        is.read(reinterpret_cast<char*>(iv), sizeof(iv));
+        node.left  = iv[0];
+        node.right = iv[1];
+        node.begin = iv[2];
+        node.end   = iv[3];
+    }
+    m_order.resize(nboxes);
+    for (auto& i : m_order) {
+        std::int32_t ii;
+        is.read(reinterpret_cast<char*>(&ii), sizeof(ii));
+        i = ii;
+    }
+
+    if (is.fail()) {
+        *this = BoxIndex();
+        return false;
+    }
+    return true;
+}
+
+}
@@ -74,6 +74,7 @@ FabArrayBase::CacheStats           FabArrayBase::m_CFinfo_stats("CrseFineCache")
 std::map<FabArrayBase::BDKey, int> FabArrayBase::m_BD_count;
 
 FabArrayBase::FabArrayStats        FabArrayBase::m_FA_stats;
+FabArrayBase::CommStats            FabArrayBase::m_comm_stats;
 
 std::map<std::string,FabArrayBase::meminfo> FabArrayBase::m_mem_usage;
 std::vector<std::string>                    FabArrayBase::m_region_tag;
@@ -61,6 +61,22 @@ RemoveAll (std::string const& p)
     return !ec;
 }
 
+std::vector<std::string>
+ListFiles (std::string const& dir)
+{
+    std::vector<std::string> r;
+    std::error_code ec;
+    const std::filesystem::path root{dir};
+    for (auto it = std::filesystem::recursive_directory_iterator(root, ec);
+         !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec))
+    {
+        if (it->is_regular_file()) {
+            r.push_back(std::filesystem::relative(it->path(), root).generic_string());
+        }
+    }
+    return r;
+}
+
 }}
 
 #else
@@ -69,6 +85,7 @@ RemoveAll (std::string const& p)
 #include <cstddef>
 #include <cstring>
 #include <unistd.h>
+#include <dirent.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/wait.h>
@@ -210,6 +227,38 @@ RemoveAll (std::string const& p)
     return true;
 }
 
+namespace {
+    void ListFilesImpl (std::string const& dir, std::string const& prefix,
+                        std::vector<std::string>& r)
+    {
+        DIR* d = opendir(dir.c_str());
+        if (d == nullptr) return;
+        while (struct dirent* e = readdir(d))
+        {
+            if (std::strcmp(e->d_name, ".") == 0 || std::strcmp(e->d_name, "..") == 0) {
+                continue;
+            }
+            const std::string path = dir + "/" + e->d_name;
+            struct stat statbuff;
+            if (lstat(path.c_str(), &statbuff) == -1) continue;
+            if (S_ISDIR(statbuff.st_mode)) {
+                ListFilesImpl(path, prefix + e->d_name + "/", r);
+            } else if (S_ISREG(statbuff.st_mode)) {
+                r.push_back(prefix + e->d_name);
+            }
+        }
+        closedir(d);
+    }
+}
+
+std::vector<std::string>
+ListFiles (std::string const& dir)
+{
+    std::vector<std::string> r;
+    ListFilesImpl(dir, std::string(), r);
+    return r;
+}
+
 }}
 
 #endif
@@ -0,0 +1,531 @@
+
+#include <AMReX_FloatCompress.H>
+#include <AMReX.H>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace amrex {
+namespace FloatCompress {
+
+namespace {
+
+    // Block header: magic (4), word size (1), flags (1), unused (2),
+    // number of words (8), number of bytes after the header (8).
+    const char magic[4] = {'A','F','C','1'};
+    const char bounded_magic[4] = {'A','F','B','1'};
+    constexpr int msb_first_flag = 1;
+    constexpr int no_delta_flag = 2;
+
+    // Quantization codes are 16 bits: 0 marks a value stored exactly, the
+    // others are the zigzag coded multiple of twice the error bound plus one.
+    constexpr int max_quant = 32767;
+
+    enum PlaneMode : unsigned char { plane_raw = 0, plane_const = 1, plane_rans = 2 };
+
+    // rANS with 32-bit state, byte-wise renormalization and 12-bit frequencies
+    constexpr std::uint32_t rans_l = 1u << 23;
+    constexpr int scale_bits = 12;
+    constexpr std::uint32_t prob_scale = 1u << scale_bits;
+
+    void putU64 (char* p, std::uint64_t v)
+    {
+        for (int k = 0; k < 8; ++k) {
+            p[k] = static_cast<char>((v >> (8*k)) & 0xff);
+        }
+    }
+
+    std::uint64_t getU64 (const char* p)
+    {
+        std::uint64_t v = 0;
+        for (int k = 0; k < 8; ++k) {
+            v |= static_cast<std::uint64_t>(static_cast<unsigned char>(p[k])) << (8*k);
+        }
+        return v;
+    }
+
+    std::uint64_t doubleBits (double d)
+    {
+        std::uint64_t u;
+        std::memcpy(&u, &d, sizeof(u));
+        return u;
+    }
+
+    double bitsDouble (std::uint64_t u)
+    {
+        double d;
+        std::memcpy(&d, &u, sizeof(d));
+        return d;
+    }
+
+    bool hostMsbFirst ()
+    {
+        const std::uint16_t one = 1;
+        unsigned char c;
+        std::memcpy(&c, &one, 1);
+        return c == 0;
+    }
+
+    void writeHeader (const char* mgc, int wordsize, int flags, Long nwords, Vector<char>& out)
+    {
+        const Long pos = out.size();
+        out.resize(pos + HeaderSize);
+        char* h = out.data() + pos;
+        std::memcpy(h, mgc, 4);
+        h[4] = static_cast<char>(wordsize);
+        h[5] = static_cast<char>(flags);
+        h[6] = h[7] = 0;
+        putU64(h+8, nwords);
+    }
+
+    // Scale the counts of the n symbols to frequencies that add up to prob_scale.
+    void normalizeFreqs (const Long counts[256], Long n, std::uint32_t freqs[256])
+    {
+        Long total = 0;
+        int maxsym = 0;
+        for (int s = 0; s < 256; ++s) {
+            if (counts[s] > 0) {
+                freqs[s] = std::max<std::uint32_t>
+                    (1, static_cast<std::uint32_t>((counts[s]*prob_scale)/n));
+            } else {
+                freqs[s] = 0;
+            }
+            total += freqs[s];
+            if (freqs[s] > freqs[maxsym]) maxsym = s;
+        }
+        // The rounding error goes to the most frequent symbol, unless that
+        // would leave it with nothing, in which case the others give up
+        // what they can.
+        Long diff = static_cast<Long>(prob_scale) - total;
+        if (static_cast<Long>(freqs[maxsym]) + diff >= 1) {
+            freqs[maxsym] += diff;
+        } else {
+            for (int s = 0; diff < 0 && s < 256; ++s) {
+                while (freqs[s] > 1 && diff < 0) {
+                    --freqs[s];
+                    ++diff;
+                }
+            }
+        }
+    }
+
+    // Encode the n bytes at in.  Return false if the result would not be
+    // smaller than the raw bytes.
+    bool ransEncode (const unsigned char* in, Long n, Vector<char>& out)
+    {
+        Long counts[256] = {0};
+        for (Long i = 0; i < n; ++i) {
+            ++counts[in[i]];
+        }
+        std::uint32_t freqs[256], cum[257];
+        normalizeFreqs(counts, n, freqs);
+        cum[0] = 0;
+        int nsyms = 0;
+        for (int s = 0; s < 256; ++s) {
+            cum[s+1] = cum[s] + freqs[s];
+            if (freqs[s] > 0) ++nsyms;
+        }
+
+        const Long table_bytes = 2 + 3*nsyms;
+        // Each symbol emits at most two bytes.
+        Vector<unsigned char> buf(2*n + 4);
+        unsigned char* const end = buf.data() + buf.size();
+        unsigned char* ptr = end;
+        std::uint32_t x = rans_l;
+        for (Long i = n-1; i >= 0; --i) {
+            const int s = in[i];
+            const std::uint32_t freq = freqs[s];
+            const std::uint32_t x_max = ((rans_l >> scale_bits) << 8) * freq;
+            while (x >= x_max) {
+                *--ptr = static_cast<unsigned char>(x & 0xff);
+                x >>= 8;
+            }
+            x = ((x / freq) << scale_bits) + (x % freq) + cum[s];
+            if (end - ptr + table_bytes + 4 >= n) return false;
+        }
+        ptr -= 4;
+        for (int k = 0; k < 4; ++k) {
+            ptr[k] = static_cast<unsigned char>((x >> (8*k)) & 0xff);
+        }
+
+        const Long stream_bytes = end - ptr;
+        if (table_bytes + stream_bytes >= n) return false;
+
+        const Long pos = out.size();
+        out.resize(pos + table_bytes + stream_bytes);
+        char* p = out.data() + pos;
+        p[0] = static_cast<char>(nsyms & 0xff);
+        p[1] = static_cast<char>(nsyms >> 8);
+        p += 2;
+        for (int s = 0; s < 256; ++s) {
+            if (freqs[s] > 0) {
+                p[0] = static_cast<char>(s);
+                p[1] = static_cast<char>(freqs[s] & 0xff);
+                p[2] = static_cast<char>(freqs[s] >> 8);
+                p += 3;
+            }
+        }
+        std::memcpy(p, ptr, stream_bytes);
+        return true;
+    }
+
+    void ransDecode (const unsigned char* in, Long nbytes, unsigned char* out, Long n)
+    {
+        if (nbytes < 2) amrex::Abort("FloatCompress: corrupt rANS plane");
+        const int nsyms = in[0] | (in[1] << 8);
+        if (nbytes < 2 + 3*nsyms + 4) amrex::Abort("FloatCompress: corrupt rANS plane");
+        const unsigned char* p = in + 2;
+
+        std::uint32_t freqs[256] = {0}, cum[256] = {0};
+        unsigned char slot_sym[prob_scale];
+        std::uint32_t c = 0;
+        for (int i = 0; i < nsyms; ++i, p += 3) {
+            const int s = p[0];
+            freqs[s] = p[1] | (p[2] << 8);
+            cum[s] = c;
+            if (freqs[s] == 0 || c + freqs[s] > prob_scale) {
+                amrex::Abort("FloatCompress: corrupt rANS frequency table");
+            }
+            std::memset(slot_sym + c, s, freqs[s]);
+            c += freqs[s];
+        }
+        if (c != prob_scale) amrex::Abort("FloatCompress: corrupt rANS frequency table");
+
+        const unsigned char* const end = in + nbytes;
+        std::uint32_t x = p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<std::uint32_t>(p[3]) << 24);
+        p += 4;
+        for (Long i = 0; i < n; ++i) {
+            const std::uint32_t slot = x & (prob_scale-1);
+            const unsigned char s = slot_sym[slot];
+            out[i] = s;
+            x = freqs[s] * (x >> scale_bits) + slot - cum[s];
+            while (x < rans_l) {
+                if (p == end) amrex::Abort("FloatCompress: truncated rANS plane");
+                x = (x << 8) | *p++;
+            }
+        }
+    }
+}
+
+void
+compress (const char* in, Long nwords, int wordsize, bool msb_first, Vector<char>& out,
+          bool delta)
+{
+    AMREX_ALWAYS_ASSERT(wordsize > 0 && wordsize <= 8);
+
+    const Long pos0 = out.size();
+    writeHeader(magic, wordsize, (msb_first ? msb_first_flag : 0) | (delta ? 0 : no_delta_flag),
+                nwords, out);
+
+    // ---- delta of the words as unsigned integers, split into byte planes
+    // ---- planes[b*nwords+i] is byte b (0 is the least significant) of word i
+    Vector<unsigned char> planes(nwords*wordsize);
+    const std::uint64_t mask = (wordsize == 8) ? ~std::uint64_t(0)
+                                               : (std::uint64_t(1) << (8*wordsize)) - 1;
+    std::uint64_t prev = 0;
+    const unsigned char* src = reinterpret_cast<const unsigned char*>(in);
+    for (Long i = 0; i < nwords; ++i, src += wordsize) {
+        std::uint64_t v = 0;
+        for (int b = 0; b < wordsize; ++b) {
+            const int k = msb_first ? wordsize-1-b : b;
+            v |= static_cast<std::uint64_t>(src[k]) << (8*b);
+        }
+        const std::uint64_t d = delta ? ((v - prev) & mask) : v;
+        prev = v;
+        for (int b = 0; b < wordsize; ++b) {
+            planes[b*nwords+i] = static_cast<unsigned char>((d >> (8*b)) & 0xff);
+        }
+    }
+
+    for (int b = 0; b < wordsize; ++b)
+    {
+        const unsigned char* plane = planes.data() + b*nwords;
+        const Long hpos = out.size();
+        out.resize(hpos + 9);
+
+        unsigned char mode;
+        if (nwords > 0 && std::all_of(plane, plane+nwords,
+                                      [=] (unsigned char c) { return c == plane[0]; })) {
+            mode = plane_const;
+            out.push_back(static_cast<char>(plane[0]));
+        } else if (ransEncode(plane, nwords, out)) {
+            mode = plane_rans;
+        } else {
+            mode = plane_raw;
+            out.insert(out.end(), reinterpret_cast<const char*>(plane),
+                       reinterpret_cast<const char*>(plane) + nwords);
+        }
+        out[hpos] = static_cast<char>(mode);
+        putU64(out.data()+hpos+1, out.size() - (hpos+9));
+    }
+
+    putU64(out.data()+pos0+16, out.size() - (pos0+HeaderSize));
+}
+
+Long
+blockSize (const char* header)
+{
+    if (std::memcmp(header, magic, 4) != 0 && !isBounded(header)) {
+        amrex::Abort("FloatCompress: not a compressed block");
+    }
+    return HeaderSize + static_cast<Long>(getU64(header+16));
+}
+
+void
+decompress (const char* in, char* out, Long nwords, int wordsize)
+{
+    const Long nbytes = blockSize(in);
+    if (std::memcmp(in, magic, 4) != 0 || in[4] != wordsize || static_cast<Long>(getU64(in+8)) != nwords) {
+        amrex::Abort("FloatCompress: block does not match the expected data");
+    }
+    const bool msb_first = in[5] & msb_first_flag;
+    const bool delta = !(in[5] & no_delta_flag);
+
+    Vector<unsigned char> planes(nwords*wordsize);
+    const char* p = in + HeaderSize;
+    const char* const end = in + nbytes;
+    for (int b = 0; b < wordsize; ++b)
+    {
+        if (end - p < 9) amrex::Abort("FloatCompress: truncated block");
+        const unsigned char mode = static_cast<unsigned char>(p[0]);
+        const Long plane_bytes = getU64(p+1);
+        p += 9;
+        if (end - p < plane_bytes) amrex::Abort("FloatCompress: truncated block");
+
+        unsigned char* plane = planes.data() + b*nwords;
+        const unsigned char* src = reinterpret_cast<const unsigned char*>(p);
+        if (mode == plane_const && plane_bytes == 1) {
+            std::memset(plane, src[0], nwords);
+        } else if (mode == plane_raw && plane_bytes == nwords) {
+            std::memcpy(plane, src, nwords);
+        } else if (mode == plane_rans) {
+            ransDecode(src, plane_bytes, plane, nwords);
+        } else {
+            amrex::Abort("FloatCompress: corrupt plane");
+        }
+        p += plane_bytes;
+    }
+
+    const std::uint64_t mask = (wordsize == 8) ? ~std::uint64_t(0)
+                                               : (std::uint64_t(1) << (8*wordsize)) - 1;
+    std::uint64_t v = 0;
+    unsigned char* dst = reinterpret_cast<unsigned char*>(out);
+    for (Long i = 0; i < nwords; ++i, dst += wordsize) {
+        std::uint64_t d = 0;
+        for (int b = 0; b < wordsize; ++b) {
+            d |= static_cast<std::uint64_t>(planes[b*nwords+i]) << (8*b);
+        }
+        v = delta ? ((v + d) & mask) : d;
+        for (int b = 0; b < wordsize; ++b) {
+            const int k = msb_first ? wordsize-1-b : b;
+            dst[k] = static_cast<unsigned char>((v >> (8*b)) & 0xff);
+        }
+    }
+}
+
+namespace {
+
+    // Lorenzo predictor from the reconstructed values r.  Neighbors
+    // outside the array are zero.
+    template <typename T>
+    double lorenzo (const T* r, Long i, Long j, Long k, Long n0, Long n1)
+    {
+        auto f = [=] (Long ii, Long jj, Long kk) -> double {
+            return (ii < 0 || jj < 0 || kk < 0) ? 0.0
+                : static_cast<double>(r[ii + n0*(jj + n1*kk)]);
+        };
+        return f(i-1,j,k) + f(i,j-1,k) + f(i,j,k-1)
+            - f(i-1,j-1,k) - f(i-1,j,k-1) - f(i,j-1,k-1)
+            + f(i-1,j-1,k-1);
+    }
+
+    // The compressor and the decompressor must reconstruct the same values.
+    // std::fma rounds once whether or not the compiler contracts a*b+c.
+    template <typename T>
+    T reconstruct (double pred, double step, int q)
+    {
+        return static_cast<T>(std::fma(step, static_cast<double>(q), pred));
+    }
+
+    template <typename T>
+    void compressBoundedT (const T* in, const Long n[3], int ncomp,
+                           const Real* errbound, Vector<char>& out)
+    {
+        const Long npts = n[0]*n[1]*n[2];
+        const Long pos0 = out.size();
+        writeHeader(bounded_magic, sizeof(T), 0, npts*ncomp, out);
+        {
+            const Long pos = out.size();
+            out.resize(pos + 32);
+            for (int d = 0; d < 3; ++d) {
+                putU64(out.data()+pos+8*d, n[d]);
+            }
+            putU64(out.data()+pos+24, ncomp);
+        }
+
+        Vector<T> r(npts);
+        Vector<unsigned char> codes(2*npts);
+        Vector<std::uint64_t> outliers;
+        Vector<char> lossy;
+        for (int m = 0; m < ncomp; ++m)
+        {
+            const T* x = in + m*npts;
+            const double eb = errbound[m] > 0 ? static_cast<double>(errbound[m]) : 0.0;
+            if (eb == 0.0) {
+                const Long pos = out.size();
+                out.resize(pos + 8);
+                putU64(out.data()+pos, doubleBits(0.0));
+                compress(reinterpret_cast<const char*>(x), npts, sizeof(T), hostMsbFirst(), out);
+                continue;
+            }
+
+            const double step = 2.0*eb;
+            outliers.clear();
+            for (Long k = 0, idx = 0; k < n[2]; ++k) {
+            for (Long j = 0; j < n[1]; ++j) {
+            for (Long i = 0; i < n[0]; ++i, ++idx) {
+                const double v = static_cast<double>(x[idx]);
+                const double pred = lorenzo(r.data(), i, j, k, n[0], n[1]);
+                unsigned int code = 0;
+                if (std::isfinite(v)) {
+                    const double qd = std::round((v - pred)/step);
+                    if (std::abs(qd) <= max_quant) {
+                        const int q = static_cast<int>(qd);
+                        const T rv = reconstruct<T>(pred, step, q);
+                        if (std::abs(static_cast<double>(rv) - v) <= eb) {
+                            r[idx] = rv;
+                            code = (q >= 0 ? 2*q : -2*q-1) + 1;
+                        }
+                    }
+                }
+                if (code == 0) {
+                    r[idx] = x[idx];
+                    outliers.push_back(doubleBits(v));
+                }
+                codes[2*idx  ] = static_cast<unsigned char>(code & 0xff);
+                codes[2*idx+1] = static_cast<unsigned char>(code >> 8);
+            }}}
+
+            lossy.resize(8);
+            putU64(lossy.data(), doubleBits(eb));
+            compress(reinterpret_cast<const char*>(codes.data()), npts, 2, false, lossy, false);
+            const Long pos = lossy.size();
+            lossy.resize(pos + 8*(1+outliers.size()));
+            putU64(lossy.data()+pos, outliers.size());
+            for (Long i = 0, N = outliers.size(); i < N; ++i) {
+                putU64(lossy.data()+pos+8*(i+1), outliers[i]);
+            }
+
+            // ---- noisy data may do better without the bound
+            const Long cpos = out.size();
+            if (static_cast<Long>(lossy.size()) > npts*static_cast<Long>(sizeof(T))/2) {
+                out.resize(cpos + 8);
+                putU64(out.data()+cpos, doubleBits(0.0));
+                compress(reinterpret_cast<const char*>(x), npts, sizeof(T), hostMsbFirst(), out);
+                if (out.size() - cpos <= lossy.size()) continue;
+                out.resize(cpos);
+            }
+            out.insert(out.end(), lossy.begin(), lossy.end());
+        }
+
+        putU64(out.data()+pos0+16, out.size() - (pos0+HeaderSize));
+    }
+
+    template <typename T>
+    void decompressBoundedT (const char* in, T* out, Long nitems)
+    {
+        const char* p = in + HeaderSize;
+        const char* const end = in + blockSize(in);
+        if (end - p < 32) amrex::Abort("FloatCompress: truncated bounded block");
+        Long n[3];
+        for (int d = 0; d < 3; ++d) {
+            n[d] = getU64(p+8*d);
+        }
+        const Long ncomp = getU64(p+24);
+        p += 32;
+        const Long npts = n[0]*n[1]*n[2];
+        if (npts*ncomp != nitems) {
+            amrex::Abort("FloatCompress: block does not match the expected data");
+        }
+
+        Vector<unsigned char> codes(2*npts);
+        for (Long m = 0; m < ncomp; ++m)
+        {
+            T* r = out + m*npts;
+            if (end - p < 8 + HeaderSize) amrex::Abort("FloatCompress: truncated bounded block");
+            const double eb = bitsDouble(getU64(p));
+            p += 8;
+            const Long zbytes = blockSize(p);
+            if (end - p < zbytes) amrex::Abort("FloatCompress: truncated bounded block");
+            if (eb == 0.0) {
+                decompress(p, reinterpret_cast<char*>(r), npts, sizeof(T));
+                p += zbytes;
+                continue;
+            }
+            decompress(p, reinterpret_cast<char*>(codes.data()), npts, 2);
+            p += zbytes;
+            if (end - p < 8) amrex::Abort("FloatCompress: truncated bounded block");
+            const Long noutliers = getU64(p);
+            p += 8;
+            if (end - p < 8*noutliers) amrex::Abort("FloatCompress: truncated bounded block");
+
+            const double step = 2.0*eb;
+            Long iout = 0;
+            for (Long k = 0, idx = 0; k < n[2]; ++k) {
+            for (Long j = 0; j < n[1]; ++j) {
+            for (Long i = 0; i < n[0]; ++i, ++idx) {
+                const unsigned int code = static_cast<unsigned int>(codes[2*idx])
+                                       | (static_cast<unsigned int>(codes[2*idx+1]) << 8);
+                if (code == 0) {
+                    if (iout == noutliers) amrex::Abort("FloatCompress: corrupt bounded block");
+                    r[idx] = static_cast<T>(bitsDouble(getU64(p+8*iout)));
+                    ++iout;
+                } else {
+                    const unsigned int z = code - 1;
+                    const int q = (z & 1) ? -static_cast<int>((z+1)/2) : static_cast<int>(z/2);
+                    r[idx] = reconstruct<T>(lorenzo(r, i, j, k, n[0], n[1]), step, q);
+                }
+            }}}
+            p += 8*noutliers;
+        }
+    }
+}
+
+void
+compressBounded (const Real* in, const int n[3], int ncomp, const Real* errbound,
+                 Vector<char>& out)
+{
+    const Long nl[3] = {n[0], n[1], n[2]};
+    compressBoundedT(in, nl, ncomp, errbound, out);
+}
+
+bool
+isBounded (const char* header)
+{
+    return std::memcmp(header, bounded_magic, 4) == 0;
+}
+
+void
+decompressBounded (const char* in, Real* out, Long nitems)
+{
+    if (!isBounded(in)) amrex::Abort("FloatCompress: not a bounded block");
+    // ---- reconstruct in the precision of the writer
+    if (in[4] == static_cast<char>(sizeof(Real))) {
+        decompressBoundedT(in, out, nitems);
+    } else if (in[4] == static_cast<char>(sizeof(double))) {
+        Vector<double> tmp(nitems);
+        decompressBoundedT(in, tmp.data(), nitems);
+        std::copy(tmp.begin(), tmp.end(), out);
+    } else if (in[4] == static_cast<char>(sizeof(float))) {
+        Vector<float> tmp(nitems);
+        decompressBoundedT(in, tmp.data(), nitems);
+        std::copy(tmp.begin(), tmp.end(), out);
+    } else {
+        amrex::Abort("FloatCompress: corrupt bounded block");
+    }
+}
+
+}
+}
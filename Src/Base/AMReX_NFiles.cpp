@@ -163,9 +163,11 @@ void NFilesIter::SetSparseFPP(const Vector<int> &ranksToWrite)
 
 NFilesIter::NFilesIter(const std::string &filename,
 		       const Vector<int> &readranks,
-                       bool setBuf)
+                       bool setBuf,
+                       int readTag)
 {
   isReading = true;
+  stReadTag = readTag;
   myProc    = ParallelDescriptor::MyProc();
   nProcs    = ParallelDescriptor::NProcs();
   fullFileName = filename;
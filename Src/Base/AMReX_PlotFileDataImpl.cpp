@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <cmath>
 #include <AMReX_PlotFileDataImpl.H>
 #include <AMReX_ParallelDescriptor.H>
 #include <AMReX_VisMF.H>
@@ -70,6 +71,7 @@ PlotFileDataImpl::PlotFileDataImpl (std::string const& plotfile_name)
 
     m_mf_name.resize(m_nlevels);
     m_vismf.resize(m_nlevels);
+    m_box_index.resize(m_nlevels);
     m_ba.resize(m_nlevels);
     m_dmap.resize(m_nlevels);
     m_ngrow.resize(m_nlevels);
@@ -88,16 +90,40 @@ PlotFileDataImpl::PlotFileDataImpl (std::string const& plotfile_name)
         is >> relname;
         m_mf_name[ilev] = m_plotfile_name + "/" + relname;
         if (m_ncomp > 0) {
-            m_vismf[ilev].reset(new VisMF(m_mf_name[ilev]));
-            m_ba[ilev] = m_vismf[ilev]->boxArray();
+            // With a BoxIndex, the FabArray header need not be read.
+            const BoxIndex& bi = m_box_index[ilev];
+            if (VisMF::ReadBoxIndex(m_mf_name[ilev], m_box_index[ilev]) && bi.size() > 0) {
+                BoxList bl(bi.box(0).ixType());
+                bl.reserve(bi.size());
+                for (int i = 0; i < bi.size(); ++i) {
+                    bl.push_back(bi.box(i));
+                }
+                m_ba[ilev] = BoxArray(std::move(bl));
+                m_ngrow[ilev] = bi.nGrowVect();
+            } else {
+                m_box_index[ilev] = BoxIndex();
+                m_vismf[ilev].reset(new VisMF(m_mf_name[ilev]));
+                m_ba[ilev] = m_vismf[ilev]->boxArray();
+                m_ngrow[ilev] = m_vismf[ilev]->nGrowVect();
+            }
             m_dmap[ilev].define(m_ba[ilev]);
-            m_ngrow[ilev] = m_vismf[ilev]->nGrowVect();
         }
     }
 }
 
 PlotFileDataImpl::~PlotFileDataImpl () {}
 
+VisMF&
+PlotFileDataImpl::vismf (int level) const
+{
+    // Read by the I/O process and broadcast, so the first call for a level
+    // is collective.
+    if (!m_vismf[level]) {
+        m_vismf[level].reset(new VisMF(m_mf_name[level]));
+    }
+    return *m_vismf[level];
+}
+
 void
 PlotFileDataImpl::syncDistributionMap (PlotFileDataImpl const& src) noexcept
 {
@@ -127,19 +153,123 @@ MultiFab
 PlotFileDataImpl::get (int level, std::string const& varname) noexcept
 {
     MultiFab mf(m_ba[level], m_dmap[level], 1, m_ngrow[level]);
-    auto r = std::find(std::begin(m_var_names), std::end(m_var_names), varname);
-    if (r == std::end(m_var_names)) {
-        amrex::Abort("PlotFileDataImpl::get: varname not found "+varname);
-    } else {
-        int icomp = std::distance(std::begin(m_var_names), r);
-        for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
-            int gid = mfi.index();
-            FArrayBox& dstfab = mf[mfi];
-            std::unique_ptr<FArrayBox> srcfab(m_vismf[level]->readFAB(gid, icomp));
-            dstfab.copy<RunOn::Host>(*srcfab);
+    int icomp = varIndex(varname);
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        mf[mfi].copy<RunOn::Host>(vismf(level).mapFAB(mfi.index(), icomp));
+    }
+    return mf;
+}
+
+FArrayBox
+PlotFileDataImpl::getFab (int level, int gid) noexcept
+{
+    if (hasBoxIndex(level)) {
+        std::unique_ptr<FArrayBox> fab(VisMF::readFAB(m_box_index[level], gid, m_mf_name[level]));
+        return std::move(*fab);
+    }
+    return m_vismf[level]->mapFAB(gid);
+}
+
+FArrayBox
+PlotFileDataImpl::getFab (int level, int gid, std::string const& varname) noexcept
+{
+    const int icomp = varIndex(varname);
+    if (hasBoxIndex(level)) {
+        std::unique_ptr<FArrayBox> fab(VisMF::readFAB(m_box_index[level], gid, m_mf_name[level], icomp));
+        return std::move(*fab);
+    }
+    return m_vismf[level]->mapFAB(gid, icomp);
+}
+
+bool
+PlotFileDataImpl::minMax (int level, std::string const& varname, Real& mn, Real& mx) const noexcept
+{
+    const int icomp = varIndex(varname);
+    VisMF const& vismf = this->vismf(level);
+    mn = vismf.min(icomp);
+    mx = vismf.max(icomp);
+    if (mn > mx) { // not in the header for the whole level, try the fabs
+        for (int i = 0, N = m_ba[level].size(); i < N; ++i) {
+            mn = std::min(mn, vismf.min(i, icomp));
+            mx = std::max(mx, vismf.max(i, icomp));
         }
     }
+    return mn <= mx;
+}
+
+bool
+PlotFileDataImpl::fabMinMax (int level, int gid, std::string const& varname, Real& mn, Real& mx) const noexcept
+{
+    const int icomp = varIndex(varname);
+    mn = vismf(level).min(gid, icomp);
+    mx = vismf(level).max(gid, icomp);
+    return mn <= mx;
+}
+
+Real
+PlotFileDataImpl::errorBound (int level, std::string const& varname) const noexcept
+{
+    return vismf(level).errorBound(varIndex(varname));
+}
+
+Vector<int>
+PlotFileDataImpl::intersections (int level, const Box& region) const
+{
+    if (hasBoxIndex(level)) {
+        return m_box_index[level].intersections(region);
+    }
+
+    Vector<int> r;
+    for (auto const& is : m_ba[level].intersections(region)) {
+        r.push_back(is.first);
+    }
+    std::sort(r.begin(), r.end());
+    return r;
+}
+
+Box
+PlotFileDataImpl::regionBox (int level, const RealBox& region) const noexcept
+{
+    const Box& domain = m_prob_domain[level];
+    IntVect lo, hi;
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        const Real dx = m_cell_size[level][idim];
+        lo[idim] = domain.smallEnd(idim)
+            + static_cast<int>(std::floor((region.lo(idim)-m_prob_lo[idim])/dx));
+        hi[idim] = domain.smallEnd(idim)
+            + static_cast<int>(std::ceil((region.hi(idim)-m_prob_lo[idim])/dx)) - 1;
+        hi[idim] = std::max(hi[idim], lo[idim]);
+    }
+    return Box(lo, hi);
+}
+
+MultiFab
+PlotFileDataImpl::get (int level, std::string const& varname, const Box& region)
+{
+    const Vector<int> gids = intersections(level, region);
+    if (gids.empty()) return MultiFab();
+
+    BoxList bl;
+    Vector<int> pmap;
+    for (int gid : gids) {
+        bl.push_back(m_ba[level][gid] & region);
+        pmap.push_back(m_dmap[level][gid]);
+    }
+    MultiFab mf(BoxArray(std::move(bl)), DistributionMapping(std::move(pmap)), 1, 0);
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        mf[mfi].copy<RunOn::Host>(getFab(level, gids[mfi.index()], varname), mfi.validbox());
+    }
     return mf;
 }
 
+int
+PlotFileDataImpl::varIndex (std::string const& varname) const noexcept
+{
+    auto r = std::find(std::begin(m_var_names), std::end(m_var_names), varname);
+    if (r == std::end(m_var_names)) {
+        amrex::Abort("PlotFileDataImpl: varname not found "+varname);
+    }
+    return std::distance(std::begin(m_var_names), r);
+}
+
 }
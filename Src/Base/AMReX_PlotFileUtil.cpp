@@ -1,6 +1,8 @@
 
+#include <cmath>
 #include <fstream>
 #include <iomanip>
+#include <limits>
 
 #include <AMReX_VisMF.H>
 #include <AMReX_AsyncOut.H>
@@ -163,6 +165,37 @@ WriteGenericPlotfileHeader (std::ostream &HeaderFile,
 	}
 }
 
+Vector<Real>
+PlotfileErrorBounds (int nlevels, const Vector<const MultiFab*>& mf,
+                     const Vector<Real>& abs_bounds, const Vector<Real>& rel_bounds)
+{
+    const int ncomp = mf[0]->nComp();
+    AMREX_ALWAYS_ASSERT(abs_bounds.empty() || abs_bounds.size() == ncomp);
+    AMREX_ALWAYS_ASSERT(rel_bounds.empty() || rel_bounds.size() == ncomp);
+
+    Vector<Real> errbound(ncomp, 0.0);
+    bool lossy = false;
+    for (int n = 0; n < ncomp; ++n) {
+        Real b = abs_bounds.empty() ? 0.0_rt : amrex::max(abs_bounds[n], 0.0_rt);
+        if (!rel_bounds.empty() && rel_bounds[n] > 0.0) {
+            Real mn = std::numeric_limits<Real>::max();
+            Real mx = std::numeric_limits<Real>::lowest();
+            for (int level = 0; level < nlevels; ++level) {
+                mn = amrex::min(mn, mf[level]->min(n));
+                mx = amrex::max(mx, mf[level]->max(n));
+            }
+            // ---- a range with infinities or NaNs gives no bound
+            const Real rb = rel_bounds[n] * (mx - mn);
+            if (std::isfinite(rb)) {
+                b = (b > 0.0) ? amrex::min(b, rb) : rb;
+            }
+        }
+        errbound[n] = b;
+        lossy = lossy || b > 0.0;
+    }
+    if (!lossy) errbound.clear();
+    return errbound;
+}
 
 void
 WriteMultiLevelPlotfile (const std::string& plotfilename, int nlevels,
@@ -174,7 +207,8 @@ WriteMultiLevelPlotfile (const std::string& plotfilename, int nlevels,
                          const std::string &versionName,
                          const std::string &levelPrefix,
                          const std::string &mfPrefix,
-                         const Vector<std::string>& extra_dirs)
+                         const Vector<std::string>& extra_dirs,
+                         const Vector<Real>& errbound)
 {
     BL_PROFILE("WriteMultiLevelPlotfile()");
 
@@ -223,9 +257,17 @@ WriteMultiLevelPlotfile (const std::string& plotfilename, int nlevels,
         }
     }
 
+    AMREX_ALWAYS_ASSERT(errbound.empty() || errbound.size() == varnames.size());
+    const VisMF::Header::Version version = VisMF::GetHeaderVersion();
+    const Vector<Real> old_errbound = VisMF::GetErrorBounds();
+    if (!errbound.empty()) {
+        VisMF::SetHeaderVersion(VisMF::Header::LossyCompressed_v1);
+        VisMF::SetErrorBounds(errbound);
+    }
+
     for (int level = 0; level <= finest_level; ++level)
     {
-        if (AsyncOut::UseAsyncOut()) {
+        if (AsyncOut::UseAsyncOut() && errbound.empty()) {
             VisMF::AsyncWrite(*mf[level],
                               MultiFabFileFullPrefix(level, plotfilename, levelPrefix, mfPrefix),
                               true);
@@ -245,6 +287,11 @@ WriteMultiLevelPlotfile (const std::string& plotfilename, int nlevels,
             VisMF::Write(*data, MultiFabFileFullPrefix(level, plotfilename, levelPrefix, mfPrefix));
         }
     }
+
+    if (!errbound.empty()) {
+        VisMF::SetHeaderVersion(version);
+        VisMF::SetErrorBounds(old_errbound);
+    }
 }
 
 // write a plotfile to disk given:
@@ -351,7 +398,8 @@ WriteSingleLevelPlotfile (const std::string& plotfilename,
                           const std::string &versionName,
                           const std::string &levelPrefix,
                           const std::string &mfPrefix,
-                          const Vector<std::string>& extra_dirs)
+                          const Vector<std::string>& extra_dirs,
+                          const Vector<Real>& errbound)
 {
     Vector<const MultiFab*> mfarr(1,&mf);
     Vector<Geometry> geomarr(1,geom);
@@ -359,7 +407,8 @@ WriteSingleLevelPlotfile (const std::string& plotfilename,
     Vector<IntVect> ref_ratio;
 
     WriteMultiLevelPlotfile(plotfilename, 1, mfarr, varnames, geomarr, time,
-                            level_steps, ref_ratio, versionName, levelPrefix, mfPrefix, extra_dirs);
+                            level_steps, ref_ratio, versionName, levelPrefix, mfPrefix,
+                            extra_dirs, errbound);
 }
 
 
@@ -10,6 +10,11 @@
 #include <array>
 #include <memory>
 #include <numeric>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
 
 #include <AMReX_ccse-mpi.H>
 #include <AMReX_Utility.H>
@@ -19,17 +24,95 @@
 #include <AMReX_FPC.H>
 #include <AMReX_FabArrayUtility.H>
 #include <AMReX_AsyncOut.H>
+#include <AMReX_BoxIndex.H>
+#include <AMReX_FloatCompress.H>
+#include <AMReX_FileSystem.H>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace amrex {
 
 static const char *TheMultiFabHdrFileSuffix = "_H";
+static const char *TheBoxIndexFileSuffix = "_I";
+static const char *TheDeltaBaseFileSuffix = "_B";
 static const char *FabFileSuffix = "_D_";
 static const char *TheFabOnDiskPrefix = "FabOnDisk:";
 
+namespace {
+    // ---- 64-bit FNV-1a hash of the bytes of s
+    std::uint64_t HashString (const std::string& s)
+    {
+        std::uint64_t h = 0xcbf29ce484222325ULL;
+        for(unsigned char c : s) {
+            h ^= c;
+            h *= 0x100000001b3ULL;
+        }
+        return h;
+    }
+
+    bool ReadWholeFile (const std::string& name, std::string& contents)
+    {
+        std::ifstream ifs(name, std::ios::in | std::ios::binary);
+        if( ! ifs.good()) {
+            return false;
+        }
+        std::ostringstream oss;
+        oss << ifs.rdbuf();
+        contents = oss.str();
+        return true;
+    }
+
+    // ---- the path of directory to relative to directory from, ending in '/'
+    std::string RelativeDirPath (const std::string& from, const std::string& to)
+    {
+        auto components = [] (const std::string& dir) {
+            std::string path(dir);
+            if(path.empty() || path[0] != '/') {
+                path = FileSystem::CurrentPath() + '/' + path;
+            }
+            Vector<std::string> r;
+            std::istringstream is(path);
+            std::string c;
+            while(std::getline(is, c, '/')) {
+                if(c.empty() || c == ".") {
+                    continue;
+                } else if(c == "..") {
+                    if( ! r.empty()) {
+                        r.pop_back();
+                    }
+                } else {
+                    r.push_back(c);
+                }
+            }
+            return r;
+        };
+        const Vector<std::string> f(components(from));
+        const Vector<std::string> t(components(to));
+        Long common(0);
+        while(common < f.size() && common < t.size() && f[common] == t[common]) {
+            ++common;
+        }
+        std::string r;
+        for(Long i(common); i < f.size(); ++i) {
+            r += "../";
+        }
+        for(Long i(common); i < t.size(); ++i) {
+            r += t[i] + '/';
+        }
+        return r;
+    }
+}
+
 std::map<std::string, VisMF::PersistentIFStream> VisMF::persistentIFStreams;
 
 int VisMF::verbose(0);
 VisMF::Header::Version VisMF::currentVersion(VisMF::Header::Version_v1);
+Vector<Real> VisMF::errorBounds;
 bool VisMF::groupSets(false);
 bool VisMF::setBuf(true);
 bool VisMF::useSingleRead(false);
@@ -39,6 +122,9 @@ bool VisMF::usePersistentIFStreams(false);
 bool VisMF::useSynchronousReads(false);
 bool VisMF::useDynamicSetSelection(true);
 bool VisMF::allowSparseWrites(true);
+bool VisMF::useAggregation(false);
+int  VisMF::aggregatorsPerNode(1);
+bool VisMF::writeBoxIndex(false);
 
 Long VisMF::ioBufferSize(VisMF::IO_Buffer_Size);
 
@@ -76,6 +162,7 @@ VisMF::Initialize ()
     if(headerVersion != currentVersion) {
       currentVersion = static_cast<VisMF::Header::Version> (headerVersion);
     }
+    pp.queryarr("errorbounds", errorBounds);
 
     pp.query("groupsets", groupSets);
     pp.query("setbuf", setBuf);
@@ -87,6 +174,12 @@ VisMF::Initialize ()
     pp.query("usedynamicsetselection", useDynamicSetSelection);
     pp.query("iobuffersize", ioBufferSize);
     pp.query("allowsparsewrites", allowSparseWrites);
+    pp.query("useaggregation", useAggregation);
+    pp.query("aggregatorspernode", aggregatorsPerNode);
+    pp.query("boxindex", writeBoxIndex);
+    if(aggregatorsPerNode < 1) {
+      amrex::Abort("VisMF::Initialize: vismf.aggregatorspernode must be positive");
+    }
 
     initialized = true;
 }
@@ -211,6 +304,27 @@ operator<< (std::ostream&               os,
     return os;
 }
 
+//
+// Read a Real followed by a ','.  Unlike operator>>, this reads the inf and
+// nan that operator<< writes for infinities and NaNs in mins and maxes.
+//
+static
+void
+readRealComma (std::istream& is,
+               Real&         r,
+               const char*   what)
+{
+    std::string tok;
+    is >> std::ws;
+    std::getline(is, tok, ',');
+    char *end(nullptr);
+    double dtemp(std::strtod(tok.c_str(), &end));
+    if(is.fail() || tok.empty() || *end != '\0') {
+      amrex::Error(std::string("Expected a number and a ',' when reading ") + what);
+    }
+    r = static_cast<Real>(dtemp);
+}
+
 static
 std::istream&
 operator>> (std::istream&         is,
@@ -218,9 +332,6 @@ operator>> (std::istream&         is,
 {
     char ch;
     Long i(0), N, M;
-#ifdef BL_USE_FLOAT
-    double dtemp;
-#endif
 
     is >> N >> ch >> M;
 
@@ -240,15 +351,7 @@ operator>> (std::istream&         is,
         ar[i].resize(M);
 
         for(Long j = 0; j < M; ++j) {
-#ifdef BL_USE_FLOAT
-            is >> dtemp >> ch;
-            ar[i][j] = static_cast<Real>(dtemp);
-#else
-            is >> ar[i][j] >> ch;
-#endif
-	    if( ch != ',' ) {
-	      amrex::Error("Expected a ',' got something else");
-	    }
+            readRealComma(is, ar[i][j], "Vector<Vector<Real>>");
         }
     }
 
@@ -284,13 +387,22 @@ operator<< (std::ostream        &os,
 
     os << hd.m_fod      << '\n';
 
-    if(hd.m_vers == VisMF::Header::Version_v1 ||
-       hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1)
+    if(hd.m_vers == VisMF::Header::Version_v1           ||
+       hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1 ||
+       VisMF::Compressed(hd.m_vers))
     {
       os << hd.m_min      << '\n';
       os << hd.m_max      << '\n';
     }
 
+    if(hd.m_vers == VisMF::Header::LossyCompressed_v1) {
+      BL_ASSERT(hd.m_errbound.size() == hd.m_ncomp);
+      for(int i(0); i < hd.m_errbound.size(); ++i) {
+        os << hd.m_errbound[i] << ',';
+      }
+      os << '\n';
+    }
+
     if(hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1) {
       BL_ASSERT(hd.m_famin.size() == hd.m_ncomp);
       BL_ASSERT(hd.m_famin.size() == hd.m_famax.size());
@@ -304,11 +416,15 @@ operator<< (std::ostream        &os,
       os << '\n';
     }
 
-    if(hd.m_vers == VisMF::Header::NoFabHeader_v1       ||
-       hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1 ||
-       hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1)
+    if(hd.m_vers == VisMF::Header::NoFabHeader_v1         ||
+       hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1   ||
+       hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1 ||
+       VisMF::Compressed(hd.m_vers))
     {
-      if(FArrayBox::getFormat() == FABio::FAB_NATIVE) {
+      if(hd.m_vers == VisMF::Header::LossyCompressed_v1) {
+        // ---- the lossy blocks hold the data in their native format
+        os << FPC::NativeRealDescriptor() << '\n';
+      } else if(FArrayBox::getFormat() == FABio::FAB_NATIVE) {
         os << FPC::NativeRealDescriptor() << '\n';
       } else if(FArrayBox::getFormat() == FABio::FAB_NATIVE_32) {
         os << FPC::Native32RealDescriptor() << '\n';
@@ -368,8 +484,9 @@ operator>> (std::istream  &is,
     is >> hd.m_fod;
     BL_ASSERT(hd.m_ba.size() == hd.m_fod.size());
 
-    if(hd.m_vers == VisMF::Header::Version_v1 ||
-       hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1)
+    if(hd.m_vers == VisMF::Header::Version_v1           ||
+       hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1 ||
+       VisMF::Compressed(hd.m_vers))
     {
       is >> hd.m_min;
       is >> hd.m_max;
@@ -377,26 +494,27 @@ operator>> (std::istream  &is,
       BL_ASSERT(hd.m_ba.size() == hd.m_max.size());
     }
 
+    if(hd.m_vers == VisMF::Header::LossyCompressed_v1) {
+      hd.m_errbound.resize(hd.m_ncomp);
+      for(int i(0); i < hd.m_errbound.size(); ++i) {
+        readRealComma(is, hd.m_errbound[i], "hd.m_errbound");
+      }
+    }
+
     if(hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1) {
-      char ch;
       hd.m_famin.resize(hd.m_ncomp);
       hd.m_famax.resize(hd.m_ncomp);
       for(int i(0); i < hd.m_famin.size(); ++i) {
-        is >> hd.m_famin[i] >> ch;
-	if( ch != ',' ) {
-	  amrex::Error("Expected a ',' when reading hd.m_famin");
-	}
+        readRealComma(is, hd.m_famin[i], "hd.m_famin");
       }
       for(int i(0); i < hd.m_famax.size(); ++i) {
-        is >> hd.m_famax[i] >> ch;
-	if( ch != ',' ) {
-	  amrex::Error("Expected a ',' when reading hd.m_famax");
-	}
+        readRealComma(is, hd.m_famax[i], "hd.m_famax");
       }
     }
-    if(hd.m_vers == VisMF::Header::NoFabHeader_v1       ||
-       hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1 ||
-       hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1)
+    if(hd.m_vers == VisMF::Header::NoFabHeader_v1         ||
+       hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1   ||
+       hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1 ||
+       VisMF::Compressed(hd.m_vers))
     {
       is >> hd.m_writtenRD;
     }
@@ -514,6 +632,18 @@ VisMF::max (int nc) const
     return m_hdr.m_famax[nc];
 }
 
+Real
+VisMF::errorBound (int nc) const
+{
+    BL_ASSERT(0 <= nc && nc < m_hdr.m_ncomp);
+
+    if(m_hdr.m_errbound.size() == 0) {  // ---- these were not in the header
+        return 0.0;
+    }
+
+    return m_hdr.m_errbound[nc];
+}
+
 const FArrayBox&
 VisMF::GetFab (int fabIndex,
                int ncomp) const
@@ -562,6 +692,214 @@ VisMF::readFAB (int idx,
     return VisMF::readFAB(idx, m_fafabname, m_hdr, ncomp);
 }
 
+struct VisMF::MappedFile
+{
+    explicit MappedFile (const std::string& fileName);
+    ~MappedFile ();
+    MappedFile (const MappedFile&) = delete;
+    MappedFile& operator= (const MappedFile&) = delete;
+
+    char* m_data = nullptr;
+    Long m_size = 0;
+};
+
+#if defined(_WIN32)
+VisMF::MappedFile::MappedFile (const std::string& /*fileName*/) {}
+VisMF::MappedFile::~MappedFile () {}
+#else
+VisMF::MappedFile::MappedFile (const std::string& fileName)
+{
+    int fd = ::open(fileName.c_str(), O_RDONLY);
+    if (fd < 0) return;
+
+    struct stat sb;
+    if (::fstat(fd, &sb) == 0 && sb.st_size > 0) {
+        // A private writable mapping, so that writing to a fab aliasing it
+        // does not fault.  The written pages are copied and never reach
+        // the file.
+        void* p = ::mmap(nullptr, sb.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            m_data = static_cast<char*>(p);
+            m_size = sb.st_size;
+        }
+    }
+    // The mapping stays valid after the file is closed.
+    ::close(fd);
+}
+
+VisMF::MappedFile::~MappedFile ()
+{
+    if (m_data) {
+        ::munmap(m_data, m_size);
+    }
+}
+#endif
+
+const VisMF::MappedFile*
+VisMF::mapFile (const std::string& fileName)
+{
+    auto& mfile = m_mapped[fileName];
+    if (!mfile) {
+        mfile.reset(new MappedFile(fileName));
+    }
+    return mfile->m_data ? mfile.get() : nullptr;
+}
+
+FArrayBox
+VisMF::mapFAB (int idx, int icomp, bool* zero_copy)
+{
+    BL_PROFILE("VisMF::mapFAB");
+
+    if (zero_copy) *zero_copy = false;
+
+    const FabOnDisk& fod = m_hdr.m_fod[idx];
+    std::string FullName(VisMF::DirName(m_fafabname));
+    FullName += fod.m_name;
+
+    Box fab_box(m_hdr.m_ba[idx]);
+    if(m_hdr.m_ngrow.max() > 0) {
+        fab_box.grow(m_hdr.m_ngrow);
+    }
+    const int ncomp = (icomp < 0) ? m_hdr.m_ncomp : 1;
+
+    const MappedFile* mfile = mapFile(FullName);
+
+    bool native = false;
+    Long offset = fod.m_head;
+    if (VisMF::Compressed(m_hdr.m_vers)) {
+        if (mfile && offset + FloatCompress::HeaderSize <= mfile->m_size &&
+            offset + FloatCompress::blockSize(mfile->m_data + offset) <= mfile->m_size)
+        {
+            FArrayBox fab(fab_box, m_hdr.m_ncomp);
+            VisMF::DecompressFab(mfile->m_data + offset, fab.dataPtr(),
+                                 fab_box.numPts() * m_hdr.m_ncomp, m_hdr.m_writtenRD);
+            if (icomp < 0) {
+                return fab;
+            }
+            FArrayBox fabcomp(fab_box, 1);
+            fabcomp.copy<RunOn::Host>(fab, icomp, 0, 1);
+            return fabcomp;
+        }
+    } else if (mfile && offset < mfile->m_size) {
+        if (m_hdr.m_vers == Header::Version_v1) {
+            //
+            // Each fab has its own header line: "FAB " followed by the
+            // RealDescriptor, the box and the number of components.
+            //
+            const char* hbeg = mfile->m_data + offset;
+            const char* hend = static_cast<const char*>
+                (std::memchr(hbeg, '\n', mfile->m_size - offset));
+            if (hend && hend-hbeg > 4 && std::strncmp(hbeg, "FAB ", 4) == 0) {
+                std::istringstream is(std::string(hbeg+4, hend));
+                RealDescriptor rd;
+                Box bx;
+                int nvar = 0;
+                is >> rd >> bx >> nvar;
+                if (!is.fail() && rd == FPC::NativeRealDescriptor() &&
+                    bx == fab_box && nvar == m_hdr.m_ncomp)
+                {
+                    native = true;
+                    offset = (hend + 1) - mfile->m_data;
+                }
+            }
+        } else {
+            native = (m_hdr.m_writtenRD == FPC::NativeRealDescriptor());
+        }
+    }
+
+    if (native) {
+        if (icomp > 0) {
+            offset += fab_box.numPts() * icomp * static_cast<Long>(sizeof(Real));
+        }
+        const Long nbytes = fab_box.numPts() * ncomp * static_cast<Long>(sizeof(Real));
+        if (offset + nbytes <= mfile->m_size) {
+            // The mapping is page aligned, so the file offset decides the
+            // alignment.  Misaligned data are copied out of the mapping.
+            if (offset % alignof(Real) == 0) {
+                if (zero_copy) *zero_copy = true;
+                return FArrayBox(fab_box, ncomp,
+                                 reinterpret_cast<Real*>(mfile->m_data + offset));
+            } else {
+                FArrayBox fab(fab_box, ncomp);
+                std::memcpy(fab.dataPtr(), mfile->m_data + offset, nbytes);
+                return fab;
+            }
+        }
+    }
+
+    std::unique_ptr<FArrayBox> fab(VisMF::readFAB(idx, m_fafabname, m_hdr, icomp));
+    return std::move(*fab);
+}
+
+void
+VisMF::CompressFabs (const FabArray<FArrayBox>& mf, const RealDescriptor& whichRD,
+                     Vector<Vector<char> >& zdata, const Vector<Real>* errbound)
+{
+    BL_PROFILE("VisMF::CompressFabs()");
+
+    const bool doConvert(whichRD != FPC::NativeRealDescriptor());
+    const int wordSize(whichRD.numBytes());
+    // ---- the most significant byte is first if the order starts with 1
+    const bool msbFirst(whichRD.order()[0] == 1);
+    const int nLocal(mf.local_size());
+
+    zdata.clear();
+    zdata.resize(nLocal);
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for(int li = 0; li < nLocal; ++li) {
+        const FArrayBox &fab = mf.atLocalIdx(li);
+        const Long nItems(fab.box().numPts() * fab.nComp());
+        if(errbound) {
+            const Dim3 len(amrex::length(fab.box()));
+            const int n[3] = {len.x, len.y, len.z};
+            FloatCompress::compressBounded(fab.dataPtr(), n, fab.nComp(),
+                                           errbound->dataPtr(), zdata[li]);
+        } else if(doConvert) {
+            Vector<char> cData(nItems * wordSize);
+            RealDescriptor::convertFromNativeFormat(static_cast<void *> (cData.dataPtr()),
+                                                    nItems, fab.dataPtr(), whichRD);
+            FloatCompress::compress(cData.dataPtr(), nItems, wordSize, msbFirst, zdata[li]);
+        } else {
+            FloatCompress::compress(reinterpret_cast<const char*>(fab.dataPtr()), nItems,
+                                    wordSize, msbFirst, zdata[li]);
+        }
+    }
+}
+
+void
+VisMF::DecompressFab (const char* zdata, Real* dst, Long nItems, const RealDescriptor& rd)
+{
+    if(FloatCompress::isBounded(zdata)) {
+        FloatCompress::decompressBounded(zdata, dst, nItems);
+    } else if(rd == FPC::NativeRealDescriptor()) {
+        FloatCompress::decompress(zdata, reinterpret_cast<char*>(dst), nItems, rd.numBytes());
+    } else {
+        Vector<char> cData(nItems * rd.numBytes());
+        FloatCompress::decompress(zdata, cData.dataPtr(), nItems, rd.numBytes());
+        RealDescriptor::convertToNativeFormat(dst, nItems, cData.dataPtr(), rd);
+    }
+}
+
+void
+VisMF::ReadCompressedFab (std::istream& is, Real* dst, Long nItems, const RealDescriptor& rd)
+{
+    Vector<char> zdata(FloatCompress::HeaderSize);
+    is.read(zdata.dataPtr(), FloatCompress::HeaderSize);
+    if( ! is.good()) {
+        amrex::Error("VisMF::ReadCompressedFab: failed to read the block header");
+    }
+    const Long blockBytes(FloatCompress::blockSize(zdata.dataPtr()));
+    zdata.resize(blockBytes);
+    is.read(zdata.dataPtr() + FloatCompress::HeaderSize, blockBytes - FloatCompress::HeaderSize);
+    if( ! is.good()) {
+        amrex::Error("VisMF::ReadCompressedFab: failed to read the block");
+    }
+    VisMF::DecompressFab(zdata.dataPtr(), dst, nItems, rd);
+}
+
 std::string
 VisMF::BaseName (const std::string& filename)
 {
@@ -660,6 +998,17 @@ VisMF::Header::Header (const FabArray<FArrayBox>& mf,
 {
 //    BL_PROFILE("VisMF::Header");
 
+    if(version == LossyCompressed_v1) {
+      const Vector<Real>& eb = VisMF::errorBounds;
+      if(eb.size() != 1 && eb.size() != m_ncomp) {
+        amrex::Abort("VisMF::Header:  LossyCompressed_v1 needs vismf.errorbounds with one bound or one per component");
+      }
+      m_errbound.resize(m_ncomp);
+      for(int i(0); i < m_ncomp; ++i) {
+        m_errbound[i] = std::max(eb[eb.size() == 1 ? 0 : i], 0.0_rt);
+      }
+    }
+
     if(version == NoFabHeader_v1) {
       m_min.clear();
       m_max.clear();
@@ -901,9 +1250,52 @@ VisMF::WriteHeaderDoit (const std::string&mf_name, const VisMF::Header& hdr)
     MFHdrFile.flush();
     MFHdrFile.close();
 
+    if(writeBoxIndex) {
+        const int nfabs(hdr.m_ba.size());
+        Vector<std::string> files(nfabs);
+        Vector<Long> offsets(nfabs);
+        for(int i(0); i < nfabs; ++i) {
+            files[i]   = hdr.m_fod[i].m_name;
+            offsets[i] = hdr.m_fod[i].m_head;
+        }
+        // ---- same format the header records; Version_v1 fabs carry
+        // ---- their own in the data files
+        const RealDescriptor* rd = &FPC::NativeRealDescriptor();
+        if(hdr.m_vers != Header::Version_v1 && hdr.m_vers != Header::LossyCompressed_v1) {
+            if(FArrayBox::getFormat() == FABio::FAB_NATIVE_32) {
+                rd = &FPC::Native32RealDescriptor();
+            } else if(FArrayBox::getFormat() == FABio::FAB_IEEE_32) {
+                rd = &FPC::Ieee32NormalRealDescriptor();
+            }
+        }
+        BoxIndex(hdr.m_ba, files, offsets, hdr.m_vers, hdr.m_ncomp, hdr.m_ngrow, *rd)
+            .write(mf_name + TheBoxIndexFileSuffix);
+    }
+
     return bytesWritten;
 }
 
+bool
+VisMF::ReadBoxIndex (const std::string& mf_name, BoxIndex& bi)
+{
+    return bi.read(mf_name + TheBoxIndexFileSuffix);
+}
+
+FArrayBox*
+VisMF::readFAB (const BoxIndex& bi, int idx, const std::string& mf_name, int whichComp)
+{
+    // A header with just what readFAB needs to read fab idx.
+    Header hdr;
+    hdr.m_vers      = bi.headerVersion();
+    hdr.m_ncomp     = bi.nComp();
+    hdr.m_ngrow     = bi.nGrowVect();
+    hdr.m_writtenRD = bi.realDescriptor();
+    hdr.m_ba        = BoxArray(bi.box(idx));
+    hdr.m_fod.push_back(FabOnDisk(bi.fileName(idx), bi.offset(idx)));
+
+    return VisMF::readFAB(0, mf_name, hdr, whichComp);
+}
+
 Long
 VisMF::WriteHeader (const std::string &mf_name, VisMF::Header &hdr,
 		    int procToWrite, MPI_Comm comm)
@@ -942,7 +1334,9 @@ VisMF::Write (const FabArray<FArrayBox>&    mf,
     // ---- add stream retry
     // ---- add stream buffer (to nfiles)
     RealDescriptor *whichRD = nullptr;
-    if(FArrayBox::getFormat() == FABio::FAB_NATIVE) {
+    if(FArrayBox::getFormat() == FABio::FAB_NATIVE ||
+       currentVersion == VisMF::Header::LossyCompressed_v1)
+    {
       whichRD = FPC::NativeRealDescriptor().clone();
     } else if(FArrayBox::getFormat() == FABio::FAB_NATIVE_32) {
       whichRD = FPC::Native32RealDescriptor().clone();
@@ -1003,116 +1397,153 @@ VisMF::Write (const FabArray<FArrayBox>&    mf,
 
     std::string filePrefix(mf_name + FabFileSuffix);
 
-    NFilesIter nfi(nOutFiles, filePrefix, groupSets, setBuf);
-
     bool oldHeader(currentVersion == VisMF::Header::Version_v1);
+    bool compressed(VisMF::Compressed(currentVersion));
+
+#ifdef BL_USE_MPI
+    const bool aggregate(useAggregation);
+#else
+    const bool aggregate(false);
+#endif
 
-    if(useSparseFPP) {
-        nfi.SetSparseFPP(procsWithDataVector);
-    } else if(useDynamicSetSelection) {
-        nfi.SetDynamic();
-    }
-    for( ; nfi.ReadyToWrite(); ++nfi) {
-        // ---- find the total number of bytes including fab headers if needed
-        const FABio &fio = FArrayBox::getFABio();
-        int whichRDBytes(whichRD->numBytes()), nFABs(0);
-        Long writeDataItems(0), writeDataSize(0);
-        for(MFIter mfi(mf); mfi.isValid(); ++mfi) {
-            const FArrayBox &fab = mf[mfi];
-            if(oldHeader) {
-                std::stringstream hss;
-                fio.write_header(hss, fab, fab.nComp());
-                bytesWritten += static_cast<std::streamoff>(hss.tellp());
+    if(aggregate) {
+        bytesWritten += VisMF::WriteAggregated(mf, filePrefix, hdr, *whichRD, coordinatorProc);
+    } else {
+        // ---- compress before taking turns on the files
+        Vector<Vector<char> > zdata;
+        Vector<Long> fabBytes;
+        if(compressed) {
+            VisMF::CompressFabs(mf, *whichRD, zdata,
+                                currentVersion == VisMF::Header::LossyCompressed_v1 ?
+                                &hdr.m_errbound : nullptr);
+            fabBytes.resize(mf.size(), 0);
+            for(MFIter mfi(mf); mfi.isValid(); ++mfi) {
+                fabBytes[mfi.index()] = zdata[mfi.LocalIndex()].size();
             }
-            bytesWritten += fab.box().numPts() * mf.nComp() * whichRDBytes;
-            ++nFABs;
-        }
-        char *allFabData(nullptr);
-        bool canCombineFABs(false);
-        if((nFABs > 1 || doConvert) && VisMF::useSingleWrite) {
-            allFabData = new(std::nothrow) char[bytesWritten];
-        }    // ---- else { no need to make a copy for one fab }
-        if(allFabData == nullptr) {
-            canCombineFABs = false;
-        } else {
-            canCombineFABs = true;
+            ParallelAllReduce::Sum(fabBytes.dataPtr(), fabBytes.size(),
+                                   ParallelDescriptor::Communicator());
         }
 
-        if(canCombineFABs) {
-            Long writePosition(0);
+        NFilesIter nfi(nOutFiles, filePrefix, groupSets, setBuf);
+
+        if(useSparseFPP) {
+            nfi.SetSparseFPP(procsWithDataVector);
+        } else if(useDynamicSetSelection) {
+            nfi.SetDynamic();
+        }
+        for( ; nfi.ReadyToWrite(); ++nfi) {
+            if(compressed) {
+                for(MFIter mfi(mf); mfi.isValid(); ++mfi) {
+                    const Vector<char> &zfab = zdata[mfi.LocalIndex()];
+                    nfi.Stream().write(zfab.dataPtr(), zfab.size());
+                    bytesWritten += zfab.size();
+                }
+                nfi.Stream().flush();
+                continue;
+            }
+            // ---- find the total number of bytes including fab headers if needed
+            const FABio &fio = FArrayBox::getFABio();
+            int whichRDBytes(whichRD->numBytes()), nFABs(0);
+            Long writeDataItems(0), writeDataSize(0);
             for(MFIter mfi(mf); mfi.isValid(); ++mfi) {
-                int hLength(0);
                 const FArrayBox &fab = mf[mfi];
-                writeDataItems = fab.box().numPts() * mf.nComp();
-                writeDataSize = writeDataItems * whichRDBytes;
-                char *afPtr = allFabData + writePosition;
                 if(oldHeader) {
                     std::stringstream hss;
                     fio.write_header(hss, fab, fab.nComp());
-                    hLength = static_cast<std::streamoff>(hss.tellp());
-                    auto tstr = hss.str();
-                    memcpy(afPtr, tstr.c_str(), hLength);  // ---- the fab header
+                    bytesWritten += static_cast<std::streamoff>(hss.tellp());
                 }
-                if(doConvert) {
-                    RealDescriptor::convertFromNativeFormat(static_cast<void *> (afPtr + hLength),
-                                                            writeDataItems,
-                                                            fab.dataPtr(), *whichRD);
-                } else {    // ---- copy from the fab
-                    memcpy(afPtr + hLength, fab.dataPtr(), writeDataSize);
-                }
-                writePosition += hLength + writeDataSize;
+                bytesWritten += fab.box().numPts() * mf.nComp() * whichRDBytes;
+                ++nFABs;
+            }
+            char *allFabData(nullptr);
+            bool canCombineFABs(false);
+            if((nFABs > 1 || doConvert) && VisMF::useSingleWrite) {
+                allFabData = new(std::nothrow) char[bytesWritten];
+            }    // ---- else { no need to make a copy for one fab }
+            if(allFabData == nullptr) {
+                canCombineFABs = false;
+            } else {
+                canCombineFABs = true;
             }
-            nfi.Stream().write(allFabData, bytesWritten);
-            nfi.Stream().flush();
-            delete [] allFabData;
 
-        } else {    // ---- write fabs individually
-            for(MFIter mfi(mf); mfi.isValid(); ++mfi) {
-                int hLength(0);
-                const FArrayBox &fab = mf[mfi];
-                writeDataItems = fab.box().numPts() * mf.nComp();
-                writeDataSize = writeDataItems * whichRDBytes;
-                if(oldHeader) {
-                    std::stringstream hss;
-                    fio.write_header(hss, fab, fab.nComp());
-                    hLength = static_cast<std::streamoff>(hss.tellp());
-                    auto tstr = hss.str();
-                    nfi.Stream().write(tstr.c_str(), hLength);    // ---- the fab header
-                    nfi.Stream().flush();
+            if(canCombineFABs) {
+                Long writePosition(0);
+                for(MFIter mfi(mf); mfi.isValid(); ++mfi) {
+                    int hLength(0);
+                    const FArrayBox &fab = mf[mfi];
+                    writeDataItems = fab.box().numPts() * mf.nComp();
+                    writeDataSize = writeDataItems * whichRDBytes;
+                    char *afPtr = allFabData + writePosition;
+                    if(oldHeader) {
+                        std::stringstream hss;
+                        fio.write_header(hss, fab, fab.nComp());
+                        hLength = static_cast<std::streamoff>(hss.tellp());
+                        auto tstr = hss.str();
+                        memcpy(afPtr, tstr.c_str(), hLength);  // ---- the fab header
+                    }
+                    if(doConvert) {
+                        RealDescriptor::convertFromNativeFormat(static_cast<void *> (afPtr + hLength),
+                                                                writeDataItems,
+                                                                fab.dataPtr(), *whichRD);
+                    } else {    // ---- copy from the fab
+                        memcpy(afPtr + hLength, fab.dataPtr(), writeDataSize);
+                    }
+                    writePosition += hLength + writeDataSize;
                 }
-                if(doConvert) {
-                    char *cDataPtr = new char[writeDataSize];
-                    RealDescriptor::convertFromNativeFormat(static_cast<void *> (cDataPtr),
-                                                            writeDataItems,
-                                                            fab.dataPtr(), *whichRD);
-                    nfi.Stream().write(cDataPtr, writeDataSize);
-                    nfi.Stream().flush();
-                    delete [] cDataPtr;
-                } else {    // ---- copy from the fab
-                    nfi.Stream().write((char *) fab.dataPtr(), writeDataSize);
-                    nfi.Stream().flush();
+                nfi.Stream().write(allFabData, bytesWritten);
+                nfi.Stream().flush();
+                delete [] allFabData;
+
+            } else {    // ---- write fabs individually
+                for(MFIter mfi(mf); mfi.isValid(); ++mfi) {
+                    int hLength(0);
+                    const FArrayBox &fab = mf[mfi];
+                    writeDataItems = fab.box().numPts() * mf.nComp();
+                    writeDataSize = writeDataItems * whichRDBytes;
+                    if(oldHeader) {
+                        std::stringstream hss;
+                        fio.write_header(hss, fab, fab.nComp());
+                        hLength = static_cast<std::streamoff>(hss.tellp());
+                        auto tstr = hss.str();
+                        nfi.Stream().write(tstr.c_str(), hLength);    // ---- the fab header
+                        nfi.Stream().flush();
+                    }
+                    if(doConvert) {
+                        char *cDataPtr = new char[writeDataSize];
+                        RealDescriptor::convertFromNativeFormat(static_cast<void *> (cDataPtr),
+                                                                writeDataItems,
+                                                                fab.dataPtr(), *whichRD);
+                        nfi.Stream().write(cDataPtr, writeDataSize);
+                        nfi.Stream().flush();
+                        delete [] cDataPtr;
+                    } else {    // ---- copy from the fab
+                        nfi.Stream().write((char *) fab.dataPtr(), writeDataSize);
+                        nfi.Stream().flush();
+                    }
                 }
             }
         }
-    }
 
-    if(nfi.GetDynamic()) {
-        coordinatorProc = nfi.CoordinatorProc();
+        if(nfi.GetDynamic()) {
+            coordinatorProc = nfi.CoordinatorProc();
+        }
+
+        VisMF::FindOffsets(mf, filePrefix, hdr, currentVersion, nfi,
+                           ParallelDescriptor::Communicator(),
+                           compressed ? &fabBytes : nullptr);
     }
 
     if (Gpu::inLaunchRegion()) {
         amrex::prefetchToDevice(mf);  // CalculateMinMax might do work on device
     }
 
-    if(currentVersion == VisMF::Header::Version_v1 ||
-       currentVersion == VisMF::Header::NoFabHeaderMinMax_v1)
+    if(currentVersion == VisMF::Header::Version_v1           ||
+       currentVersion == VisMF::Header::NoFabHeaderMinMax_v1 ||
+       VisMF::Compressed(currentVersion))
     {
         hdr.CalculateMinMax(mf, coordinatorProc);
     }
 
-    VisMF::FindOffsets(mf, filePrefix, hdr, currentVersion, nfi,
-                       ParallelDescriptor::Communicator());
-
     bytesWritten += VisMF::WriteHeader(mf_name, hdr, coordinatorProc);
 
     delete whichRD;
@@ -1121,6 +1552,145 @@ VisMF::Write (const FabArray<FArrayBox>&    mf,
 }
 
 
+Long
+VisMF::WriteDelta (const FabArray<FArrayBox>& mf,
+                   const std::string& mf_name,
+                   const std::string& base_name,
+                   const Vector<int>& changed,
+                   VisMF::How how)
+{
+    BL_PROFILE("VisMF::WriteDelta()");
+    BL_ASSERT(mf_name[mf_name.length() - 1] != '/');
+    AMREX_ALWAYS_ASSERT(changed.size() == mf.size());
+
+    const int coordinatorProc(ParallelDescriptor::IOProcessorNumber());
+    const bool isCoordinator(ParallelDescriptor::MyProc() == coordinatorProc);
+
+    // ---- the base must be readable and have the same layout
+    VisMF::Header baseHdr;
+    std::string baseHdrContents;
+    int baseOK(0);
+    if(isCoordinator) {
+        if(ReadWholeFile(base_name + TheMultiFabHdrFileSuffix, baseHdrContents)) {
+            std::istringstream ifs(baseHdrContents);
+            ifs >> baseHdr;
+            baseOK = baseHdr.m_vers  == currentVersion     &&
+                     baseHdr.m_ncomp == mf.nComp()         &&
+                     baseHdr.m_ngrow == mf.nGrowVect()     &&
+                     baseHdr.m_ba    == mf.boxArray();
+        }
+    }
+    ParallelDescriptor::Bcast(&baseOK, 1, coordinatorProc);
+    if( ! baseOK) {
+        return VisMF::Write(mf, mf_name, how);
+    }
+
+    // ---- write the changed fabs as a FabArray of their own
+    Vector<int> gids;
+    BoxList bl(mf.boxArray().ixType());
+    Vector<int> pmap;
+    for(int i(0); i < mf.size(); ++i) {
+        if(changed[i]) {
+            gids.push_back(i);
+            bl.push_back(mf.boxArray()[i]);
+            pmap.push_back(mf.DistributionMap()[i]);
+        }
+    }
+
+    Long bytesWritten(0);
+    const std::string delta_name(mf_name + "_Delta");
+    if( ! gids.empty()) {
+        FabArray<FArrayBox> delta(BoxArray(std::move(bl)), DistributionMapping(std::move(pmap)),
+                                  mf.nComp(), mf.nGrowVect());
+        for(MFIter mfi(delta); mfi.isValid(); ++mfi) {
+            delta[mfi].copy<RunOn::Host>(mf[gids[mfi.index()]]);
+        }
+        bytesWritten += VisMF::Write(delta, delta_name, how);
+    }
+
+    // ---- the header of mf_name takes the changed fabs from the delta
+    // ---- and the others from the base
+    bool calcMinMax(false);
+    VisMF::Header hdr(mf, how, currentVersion, calcMinMax);
+    if(currentVersion == VisMF::Header::Version_v1           ||
+       currentVersion == VisMF::Header::NoFabHeaderMinMax_v1 ||
+       VisMF::Compressed(currentVersion))
+    {
+        hdr.CalculateMinMax(mf, coordinatorProc);
+    }
+
+    if(isCoordinator) {
+        const std::string baseDir(RelativeDirPath(VisMF::DirName(mf_name),
+                                                  VisMF::DirName(base_name)));
+        for(int i(0); i < hdr.m_fod.size(); ++i) {
+            hdr.m_fod[i] = baseHdr.m_fod[i];
+            hdr.m_fod[i].m_name = baseDir + baseHdr.m_fod[i].m_name;
+        }
+        if( ! gids.empty()) {
+            VisMF::Header deltaHdr;
+            std::ifstream ifs(delta_name + TheMultiFabHdrFileSuffix);
+            ifs >> deltaHdr;
+            for(int j(0); j < gids.size(); ++j) {
+                hdr.m_fod[gids[j]] = deltaHdr.m_fod[j];
+            }
+            ifs.close();
+            std::remove((delta_name + TheMultiFabHdrFileSuffix).c_str());
+            std::remove((delta_name + TheBoxIndexFileSuffix).c_str());
+        }
+
+        // ---- record which base this delta needs, see CheckDeltaBase
+        const std::string baseFileName(mf_name + TheDeltaBaseFileSuffix);
+        std::ofstream bfs(baseFileName, std::ios::out | std::ios::trunc);
+        if( ! bfs.good()) {
+            amrex::FileOpenFailed(baseFileName);
+        }
+        bfs << baseDir + VisMF::BaseName(base_name) << '\n'
+            << std::hex << HashString(baseHdrContents) << '\n';
+        if( ! bfs.good()) {
+            amrex::Error("VisMF::WriteDelta: failed to write " + baseFileName);
+        }
+    }
+
+    bytesWritten += VisMF::WriteHeader(mf_name, hdr, coordinatorProc);
+
+    return bytesWritten;
+}
+
+
+void
+VisMF::CheckDeltaBase (const std::string& mf_name)
+{
+    if( ! ParallelDescriptor::IOProcessor()) {
+        return;
+    }
+
+    std::string baseRecord;
+    if( ! ReadWholeFile(mf_name + TheDeltaBaseFileSuffix, baseRecord)) {
+        return;  // ---- not a delta
+    }
+    std::istringstream is(baseRecord);
+    std::string baseRelName;
+    std::uint64_t baseHash(0);
+    is >> baseRelName >> std::hex >> baseHash;
+    if(is.fail()) {
+        amrex::Abort("VisMF::CheckDeltaBase: unable to read " + mf_name + TheDeltaBaseFileSuffix);
+    }
+
+    const std::string base_name(VisMF::DirName(mf_name) + baseRelName);
+    std::string baseHdrContents;
+    if( ! ReadWholeFile(base_name + TheMultiFabHdrFileSuffix, baseHdrContents)) {
+        amrex::Abort("VisMF: " + mf_name + " is a delta of " + base_name +
+                     ", which is missing.  Restore the checkpoint it belongs to"
+                     " or restart from a full checkpoint.");
+    }
+    if(HashString(baseHdrContents) != baseHash) {
+        amrex::Abort("VisMF: " + mf_name + " is a delta of " + base_name +
+                     ", which has been rewritten since the delta was written."
+                     "  Restart from a full checkpoint.");
+    }
+}
+
+
 Long
 VisMF::WriteOnlyHeader (const FabArray<FArrayBox> & mf,
                         const std::string         & mf_name,
@@ -1160,7 +1730,8 @@ VisMF::FindOffsets (const FabArray<FArrayBox> &mf,
 		    const std::string &filePrefix,
                     VisMF::Header &hdr,
 		    VisMF::Header::Version /*whichVersion*/,
-		    NFilesIter &nfi, MPI_Comm comm)
+		    NFilesIter &nfi, MPI_Comm comm,
+                    const Vector<Long>* fabBytes)
 {
 //    BL_PROFILE("VisMF::FindOffsets");
 
@@ -1309,8 +1880,12 @@ VisMF::FindOffsets (const FabArray<FArrayBox> &mf,
 	      for(int i(0); i < index.size(); ++i) {
                  hdr.m_fod[index[i]].m_name = whichFileName;
                  hdr.m_fod[index[i]].m_head = currentOffset[whichFileNumber];
-                 currentOffset[whichFileNumber] += mf.fabbox(index[i]).numPts() * nComps * whichRDBytes
-	                                           + fabHeaderBytes[index[i]];
+                 if(fabBytes) {
+                   currentOffset[whichFileNumber] += (*fabBytes)[index[i]];
+                 } else {
+                   currentOffset[whichFileNumber] += mf.fabbox(index[i]).numPts() * nComps * whichRDBytes
+                                                   + fabHeaderBytes[index[i]];
+                 }
               }
             }
 	  }
@@ -1321,6 +1896,248 @@ VisMF::FindOffsets (const FabArray<FArrayBox> &mf,
 }
 
 
+const Vector<int>&
+VisMF::AggregatorRanks ()
+{
+    // ---- [rank] -> rank of its aggregator, cached between writes
+    static Vector<int> aggRanks;
+    static int aggsPerNode(-1);
+
+    const int nProcs(ParallelDescriptor::NProcs());
+    if(aggRanks.size() == nProcs && aggsPerNode == aggregatorsPerNode) {
+      return aggRanks;
+    }
+    aggsPerNode = aggregatorsPerNode;
+    aggRanks.resize(nProcs);
+
+#ifdef BL_USE_MPI
+    const int myProc(ParallelDescriptor::MyProc());
+    MPI_Comm nodeComm;
+    BL_MPI_REQUIRE( MPI_Comm_split_type(ParallelDescriptor::Communicator(),
+                                        MPI_COMM_TYPE_SHARED, myProc,
+                                        MPI_INFO_NULL, &nodeComm) );
+    int nodeRank(0), nodeSize(1);
+    MPI_Comm_rank(nodeComm, &nodeRank);
+    MPI_Comm_size(nodeComm, &nodeSize);
+
+    Vector<int> nodeProcs(nodeSize);
+    BL_MPI_REQUIRE( MPI_Allgather(&myProc, 1, MPI_INT, nodeProcs.dataPtr(), 1, MPI_INT,
+                                  nodeComm) );
+    MPI_Comm_free(&nodeComm);
+
+    // ---- the node is split into contiguous groups, each led by its first process
+    const int nGroups(std::min(aggregatorsPerNode, nodeSize));
+    const int groupSize((nodeSize + nGroups - 1) / nGroups);
+    int myAgg(nodeProcs[(nodeRank / groupSize) * groupSize]);
+
+    BL_MPI_REQUIRE( MPI_Allgather(&myAgg, 1, MPI_INT, aggRanks.dataPtr(), 1, MPI_INT,
+                                  ParallelDescriptor::Communicator()) );
+#else
+    aggRanks[0] = 0;
+#endif
+
+    return aggRanks;
+}
+
+
+Long
+VisMF::WriteAggregated (const FabArray<FArrayBox>& mf,
+                        const std::string& filePrefix,
+                        VisMF::Header& hdr,
+                        const RealDescriptor& whichRD,
+                        int coordinatorProc)
+{
+    BL_PROFILE("VisMF::WriteAggregated()");
+
+#ifdef BL_USE_MPI
+    const int myProc(ParallelDescriptor::MyProc());
+    const int nProcs(ParallelDescriptor::NProcs());
+    const Vector<int>& aggRanks = VisMF::AggregatorRanks();
+    const int myAgg(aggRanks[myProc]);
+
+    const BoxArray& ba = mf.boxArray();
+    const DistributionMapping& dm = mf.DistributionMap();
+    const int nComps(mf.nComp());
+    const bool oldHeader(hdr.m_vers == VisMF::Header::Version_v1);
+    const bool compressed(VisMF::Compressed(hdr.m_vers));
+    const bool doConvert(whichRD != FPC::NativeRealDescriptor());
+    const Long whichRDBytes(whichRD.numBytes());
+    const FABio& fio = FArrayBox::getFABio();
+
+    // ---- the bytes of every fab are known everywhere (compressed sizes
+    // ---- are summed up first), so the aggregators and the coordinator
+    // ---- do not need to be told the message sizes
+    auto fabHeaderBytes = [&] (int i) -> Long {
+        if( ! oldHeader) {
+          return 0;
+        }
+        std::stringstream hss;
+        FArrayBox tempFab(mf.fabbox(i), nComps, false);  // ---- no alloc
+        fio.write_header(hss, tempFab, nComps);
+        return static_cast<std::streamoff>(hss.tellp());
+    };
+    Vector<Vector<int> > rankFabs(nProcs);
+    for(int i(0); i < ba.size(); ++i) {
+      rankFabs[dm[i]].push_back(i);
+    }
+    Vector<Long> fabBytes(ba.size(), 0);
+    Vector<Long> rankBytes(nProcs, 0);
+    Vector<Vector<char> > zdata;
+    if(compressed) {
+      VisMF::CompressFabs(mf, whichRD, zdata,
+                          hdr.m_vers == VisMF::Header::LossyCompressed_v1 ? &hdr.m_errbound : nullptr);
+      for(MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        fabBytes[mfi.index()] = zdata[mfi.LocalIndex()].size();
+      }
+      ParallelAllReduce::Sum(fabBytes.dataPtr(), fabBytes.size(),
+                             ParallelDescriptor::Communicator());
+    }
+    for(int rank(0); rank < nProcs; ++rank) {
+      if(rank == myProc || aggRanks[rank] == myProc || myProc == coordinatorProc) {
+        for(int i : rankFabs[rank]) {
+          if( ! compressed) {
+            fabBytes[i] = fabHeaderBytes(i) + mf.fabbox(i).numPts() * nComps * whichRDBytes;
+          }
+          rankBytes[rank] += fabBytes[i];
+        }
+      }
+    }
+
+    // ---- pack my fabs
+    Vector<char> myData(rankBytes[myProc]);
+    if(compressed) {
+      Long writePosition(0);
+      for(MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        Vector<char>& zfab = zdata[mfi.LocalIndex()];
+        std::memcpy(myData.dataPtr() + writePosition, zfab.dataPtr(), zfab.size());
+        writePosition += zfab.size();
+        Vector<char>().swap(zfab);
+      }
+    } else {
+      Long writePosition(0);
+      for(MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        const FArrayBox& fab = mf[mfi];
+        char *afPtr = myData.dataPtr() + writePosition;
+        Long hLength(0);
+        if(oldHeader) {
+          std::stringstream hss;
+          fio.write_header(hss, fab, fab.nComp());
+          hLength = static_cast<std::streamoff>(hss.tellp());
+          auto tstr = hss.str();
+          std::memcpy(afPtr, tstr.c_str(), hLength);
+        }
+        const Long writeDataItems(fab.box().numPts() * nComps);
+        if(doConvert) {
+          RealDescriptor::convertFromNativeFormat(static_cast<void *> (afPtr + hLength),
+                                                  writeDataItems, fab.dataPtr(), whichRD);
+        } else {
+          std::memcpy(afPtr + hLength, fab.dataPtr(), writeDataItems * whichRDBytes);
+        }
+        writePosition += fabBytes[mfi.index()];
+      }
+      BL_ASSERT(writePosition == rankBytes[myProc]);
+    }
+
+    // ---- file numbers follow the order of the aggregators
+    Vector<int> aggList;
+    for(int rank(0); rank < nProcs; ++rank) {
+      if(aggRanks[rank] == rank) {
+        aggList.push_back(rank);
+      }
+    }
+    auto fileName = [&] (int agg) -> std::string {
+        int fileNumber(std::lower_bound(aggList.begin(), aggList.end(), agg) - aggList.begin());
+        return NFilesIter::FileName(fileNumber, filePrefix);
+    };
+
+    const int tag(ParallelDescriptor::SeqNum());
+    constexpr Long maxMsgBytes(1L << 30);
+    auto postRecvs = [&] (char *buf, Long nbytes, int rank, Vector<MPI_Request>& reqs) {
+        for(Long pos(0); pos < nbytes; pos += maxMsgBytes) {
+          reqs.push_back(MPI_REQUEST_NULL);
+          int cnt(static_cast<int>(std::min(maxMsgBytes, nbytes - pos)));
+          BL_MPI_REQUIRE( MPI_Irecv(buf + pos, cnt, MPI_CHAR, rank, tag,
+                                    ParallelDescriptor::Communicator(), &reqs.back()) );
+        }
+    };
+
+    if(myProc == myAgg) {
+      // ---- receive the next member while writing the current one
+      Vector<int> members;
+      for(int rank(myProc + 1); rank < nProcs; ++rank) {
+        if(aggRanks[rank] == myProc && rankBytes[rank] > 0) {
+          members.push_back(rank);
+        }
+      }
+
+      const std::string fullFileName(fileName(myProc));
+      VisMF::IO_Buffer io_buffer(ioBufferSize);
+      std::ofstream ofs;
+      if(setBuf) {
+        ofs.rdbuf()->pubsetbuf(io_buffer.dataPtr(), io_buffer.size());
+      }
+      ofs.open(fullFileName.c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
+      if( ! ofs.good()) {
+        amrex::FileOpenFailed(fullFileName);
+      }
+
+      Vector<char> recvBuf[2];
+      Vector<MPI_Request> reqs[2];
+      if( ! members.empty()) {
+        recvBuf[0].resize(rankBytes[members[0]]);
+        postRecvs(recvBuf[0].dataPtr(), rankBytes[members[0]], members[0], reqs[0]);
+      }
+
+      ofs.write(myData.dataPtr(), myData.size());
+      myData.clear();
+      myData.shrink_to_fit();
+
+      for(int m(0); m < members.size(); ++m) {
+        const int cur(m % 2), nxt((m + 1) % 2);
+        if(m + 1 < members.size()) {
+          recvBuf[nxt].resize(rankBytes[members[m+1]]);
+          postRecvs(recvBuf[nxt].dataPtr(), rankBytes[members[m+1]], members[m+1], reqs[nxt]);
+        }
+        Vector<MPI_Status> status(reqs[cur].size());
+        ParallelDescriptor::Waitall(reqs[cur], status);
+        reqs[cur].clear();
+        ofs.write(recvBuf[cur].dataPtr(), recvBuf[cur].size());
+      }
+
+      ofs.flush();
+      if( ! ofs.good()) {
+        amrex::Abort("VisMF::WriteAggregated: failed to write " + fullFileName);
+      }
+    } else if( ! myData.empty()) {
+      for(Long pos(0); pos < myData.size(); pos += maxMsgBytes) {
+        int cnt(static_cast<int>(std::min(maxMsgBytes, myData.size() - pos)));
+        BL_MPI_REQUIRE( MPI_Send(myData.dataPtr() + pos, cnt, MPI_CHAR, myAgg, tag,
+                                 ParallelDescriptor::Communicator()) );
+      }
+    }
+
+    if(myProc == coordinatorProc) {   // ---- offsets in the aggregated files
+      Vector<Long> currentOffset(nProcs, 0L);
+      for(int rank(0); rank < nProcs; ++rank) {
+        const int agg(aggRanks[rank]);
+        const std::string whichFileName(VisMF::BaseName(fileName(agg)));
+        for(int i : rankFabs[rank]) {
+          hdr.m_fod[i].m_name = whichFileName;
+          hdr.m_fod[i].m_head = currentOffset[agg];
+          currentOffset[agg] += fabBytes[i];
+        }
+      }
+    }
+
+    return rankBytes[myProc];
+#else
+    amrex::ignore_unused(mf, filePrefix, hdr, whichRD, coordinatorProc);
+    amrex::Abort("VisMF::WriteAggregated requires MPI");
+    return 0;
+#endif
+}
+
+
 void
 VisMF::RemoveFiles(const std::string &mf_name, bool a_verbose)
 {
@@ -1411,6 +2228,15 @@ VisMF::readFAB (int                  idx,
       } else {
         fab->readFrom(*infs, whichComp);
       }
+    } else if(VisMF::Compressed(hdr.m_vers)) {
+      const Long readDataItems(fab_box.numPts() * hdr.m_ncomp);
+      if(whichComp == -1) {    // ---- read all components
+        VisMF::ReadCompressedFab(*infs, fab->dataPtr(), readDataItems, hdr.m_writtenRD);
+      } else {                 // ---- the components are compressed together
+        FArrayBox tmp(fab_box, hdr.m_ncomp);
+        VisMF::ReadCompressedFab(*infs, tmp.dataPtr(), readDataItems, hdr.m_writtenRD);
+        fab->copy<RunOn::Host>(tmp, whichComp, 0, 1);
+      }
     } else {
       if(whichComp == -1) {    // ---- read all components
 	if(hdr.m_writtenRD == FPC::NativeRealDescriptor()) {
@@ -1455,19 +2281,31 @@ VisMF::readFAB (FabArray<FArrayBox> &mf,
     std::ifstream *infs = VisMF::OpenStream(FullName);
     infs->seekg(hdr.m_fod[idx].m_head, std::ios::beg);
 
-    if(NoFabHeader(hdr)) {
+    VisMF::readFAB(*infs, fab, hdr);
+
+    VisMF::CloseStream(FullName);
+}
+
+
+void
+VisMF::readFAB (std::istream        &is,
+                FArrayBox           &fab,
+                const VisMF::Header &hdr)
+{
+    if(VisMF::Compressed(hdr.m_vers)) {
+      VisMF::ReadCompressedFab(is, fab.dataPtr(), fab.box().numPts() * fab.nComp(),
+                               hdr.m_writtenRD);
+    } else if(NoFabHeader(hdr)) {
       if(hdr.m_writtenRD == FPC::NativeRealDescriptor()) {
-        infs->read((char *) fab.dataPtr(), fab.nBytes());
+        is.read((char *) fab.dataPtr(), fab.nBytes());
       } else {
         Long readDataItems(fab.box().numPts() * fab.nComp());
         RealDescriptor::convertToNativeFormat(fab.dataPtr(), readDataItems,
-	                                      *infs, hdr.m_writtenRD);
+	                                      is, hdr.m_writtenRD);
       }
     } else {
-      fab.readFrom(*infs);
+      fab.readFrom(is);
     }
-
-    VisMF::CloseStream(FullName);
 }
 
 
@@ -1536,10 +2374,16 @@ VisMF::Read (FabArray<FArrayBox> &mf,
   int nOpensPerFile(nMFFileInStreams);
   int nProcs(ParallelDescriptor::NProcs());
   bool noFabHeader(NoFabHeader(hdr));
+  // ---- only fixed size fabs can be combined into one read
+  bool fixedFabSize(noFabHeader && ! VisMF::Compressed(hdr.m_vers));
 
-  if(noFabHeader && useSynchronousReads) {
+  if(useSynchronousReads) {
 
-    // ---- This code is only for reading in file order
+    // ---- This code is only for reading in file order.  The fabs of all
+    // ---- files are sorted by file and offset and split into contiguous
+    // ---- extents of about equal size, one per rank, whatever the number
+    // ---- of ranks that wrote them.  Each rank reads its extent
+    // ---- sequentially, then the fabs are redistributed to mf.
     bool doConvert(hdr.m_writtenRD != FPC::NativeRealDescriptor());
 
     // ---- Create an ordered map of which processors read which
@@ -1549,24 +2393,18 @@ VisMF::Read (FabArray<FArrayBox> &mf,
     std::map<std::string, std::set<int> > readFileRanks;              // ---- [filename, ranks]
 
     int nBoxes(hdr.m_ba.size());
+    Long totalPts(0);
     for(int i(0); i < nBoxes; ++i) {   // ---- create the map
       int undefined(-1);
       std::string fname(hdr.m_fod[i].m_name);
-      FileReadChains[fname].push_back(FabReadLink(undefined, undefined, hdr.m_fod[i].m_head, hdr.m_ba[i]));
+      FileReadChains[fname].push_back(FabReadLink(undefined, i, hdr.m_fod[i].m_head, hdr.m_ba[i]));
+      totalPts += hdr.m_ba[i].numPts();
     }
 
     std::map<std::string, Vector<FabReadLink> >::iterator frcIter;
 
-    int indexFileOrder(0);
-    int currentRank(0);
-    FabArray<FArrayBox> fafabFileOrder;
-    BoxArray baFileOrder(hdr.m_ba.size());
-
-    Vector<int> ranksFileOrder(mf.DistributionMap().size(), -1);
-
-    Vector<int> nRanksPerFile(FileReadChains.size());
-    amrex::NItemsPerBin(nProcs, nRanksPerFile);
-    int currentFileIndex(0);
+    Vector<int> ranksFileOrder(nBoxes, -1);
+    Long currentPts(0);
 
     for(frcIter = FileReadChains.begin(); frcIter != FileReadChains.end(); ++frcIter) {
       const std::string &fileName = frcIter->first;
@@ -1575,31 +2413,25 @@ VisMF::Read (FabArray<FArrayBox> &mf,
       std::sort(frc.begin(), frc.end(), [] (const FabReadLink &a, const FabReadLink &b)
 	                                      { return a.fileOffset < b.fileOffset; } );
 
-      Vector<int> nBoxesPerRank(nRanksPerFile[currentFileIndex]);
-      amrex::NItemsPerBin(frc.size(), nBoxesPerRank);
-      int frcIndex(0);
+      for(int i(0); i < frc.size(); ++i) {
+        // ---- the rank whose extent holds the middle of this fab
+        Long midPts(currentPts + frc[i].box.numPts() / 2);
+        int rankToRead(static_cast<int>(static_cast<double>(midPts) * nProcs / totalPts));
+        rankToRead = std::min(rankToRead, nProcs - 1);
 
-      for(int nbpr(0); nbpr < nBoxesPerRank.size(); ++nbpr) {
-        for(int nb(0); nb < nBoxesPerRank[nbpr]; ++nb) {
+        frc[i].rankToRead = rankToRead;
+        ranksFileOrder[frc[i].faIndex] = rankToRead;
+        readFileRanks[fileName].insert(rankToRead);
 
-	  baFileOrder.set(indexFileOrder, frc[frcIndex].box);
-	  ranksFileOrder[indexFileOrder] = currentRank;
-	  frc[frcIndex].rankToRead = currentRank;
-	  frc[frcIndex].faIndex    = indexFileOrder;
-	  readFileRanks[fileName].insert(currentRank);
-
-	  ++frcIndex;
-	  ++indexFileOrder;
-        }
-        ++currentRank;
-        currentRank = std::min(currentRank, nProcs - 1);
+        currentPts += frc[i].box.numPts();
       }
-      ++currentFileIndex;
     }
 
     DistributionMapping dmFileOrder(std::move(ranksFileOrder));
+    FabArray<FArrayBox> fafabFileOrder;
 
-    bool inFileOrder(mf.DistributionMap() == dmFileOrder && mf.boxArray() == baFileOrder);
+    bool inFileOrder(mf.DistributionMap() == dmFileOrder &&
+                     mf.nComp() == hdr.m_ncomp && mf.nGrowVect() == hdr.m_ngrow);
     if(inFileOrder) {
       if(myProc == coordinatorProc && verbose) {
           amrex::AllPrint() << "VisMF::Read:  inFileOrder" << std::endl;
@@ -1609,12 +2441,15 @@ VisMF::Read (FabArray<FArrayBox> &mf,
           amrex::AllPrint() << "VisMF::Read:  not inFileOrder" << std::endl;
       }
       // ---- make a temporary fabarray in file order
-      fafabFileOrder.define(baFileOrder, dmFileOrder, hdr.m_ncomp, hdr.m_ngrow, MFInfo(), mf.Factory());
+      fafabFileOrder.define(mf.boxArray(), dmFileOrder, hdr.m_ncomp, hdr.m_ngrow, MFInfo(), mf.Factory());
     }
 
     FabArray<FArrayBox> &whichFA = inFileOrder ? mf : fafabFileOrder;
+    int readTag(ParallelDescriptor::SeqNum());
 
-    // ---- check that a rank only needs to read one file
+    // ---- a rank reads its files in order.  It is the last reader of all
+    // ---- but its last file and the first of all but its first, so the
+    // ---- readers of a file only ever wait for lower ranks.
     std::map<std::string, std::set<int> >::iterator rfrIter;
     std::set<int>::iterator setIter;
 
@@ -1651,7 +2486,7 @@ VisMF::Read (FabArray<FArrayBox> &mf,
 	  frcIter = FileReadChains.find(fileName);
 	  BL_ASSERT(frcIter != FileReadChains.end());
           Vector<FabReadLink> &frc = frcIter->second;
-          for(NFilesIter nfi(fullFileName, readRanks); nfi.ReadyToRead(); ++nfi) {
+          for(NFilesIter nfi(fullFileName, readRanks, false, readTag); nfi.ReadyToRead(); ++nfi) {
 
 	      // ---- confirm the data is contiguous in the stream
 	      Long firstOffset(-1);
@@ -1662,11 +2497,11 @@ VisMF::Read (FabArray<FArrayBox> &mf,
 		}
 	      }
 
-	      bool dataIsContiguous(true);
+	      bool dataIsContiguous(fixedFabSize);
 	      Long currentOffset(firstOffset), bytesToRead(0);
 	      int nFABs(0);
 
-	      for(int i(0); i < frc.size(); ++i) {
+	      for(int i(0); i < frc.size() && fixedFabSize; ++i) {
 	        if(myProc == frc[i].rankToRead) {
 	          if(currentOffset != frc[i].fileOffset) {
                     dataIsContiguous = false;
@@ -1717,14 +2552,7 @@ VisMF::Read (FabArray<FArrayBox> &mf,
 	            if(static_cast<std::streamoff>(nfi.SeekPos()) != frc[i].fileOffset) {
                       nfi.Stream().seekp(frc[i].fileOffset, std::ios::beg);
 	            }
-	            FArrayBox &fab = whichFA[frc[i].faIndex];
-		    Long readDataItems(fab.box().numPts() * fab.nComp());
-		    if(doConvert) {
-		      RealDescriptor::convertToNativeFormat(fab.dataPtr(), readDataItems,
-		                                            nfi.Stream(), hdr.m_writtenRD);
-		    } else {
-                      nfi.Stream().read((char *) fab.dataPtr(), fab.nBytes());
-		    }
+	            VisMF::readFAB(nfi.Stream(), whichFA[frc[i].faIndex], hdr);
 	          }
 	        }
 	      }
@@ -1737,11 +2565,12 @@ VisMF::Read (FabArray<FArrayBox> &mf,
 
     if( ! inFileOrder) {
       faCopyTime = amrex::second();
-      mf.copy(fafabFileOrder);
+      mf.Redistribute(fafabFileOrder, 0, 0, std::min(mf.nComp(), hdr.m_ncomp),
+                      amrex::min(mf.nGrowVect(), hdr.m_ngrow));
       faCopyTime = amrex::second() - faCopyTime;
     }
 
-  } else {    // ---- (noFabHeader && useSynchronousReads) == false
+  } else {    // ---- useSynchronousReads == false
 
     int nReqs(0), ioProcNum(coordinatorProc);
     int nBoxes(hdr.m_ba.size());
@@ -2084,7 +2913,8 @@ VisMF::clear ()
 bool VisMF::NoFabHeader(const VisMF::Header &hdr) {
   if(hdr.m_vers == VisMF::Header::NoFabHeader_v1       ||
     hdr.m_vers == VisMF::Header::NoFabHeaderMinMax_v1 ||
-    hdr.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1)
+    hdr.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1 ||
+    VisMF::Compressed(hdr.m_vers))
   {
     return true;
   }
@@ -2293,6 +3123,14 @@ VisMF::AsyncWriteDoit (const FabArray<FArrayBox>& mf, const std::string& mf_name
     }
 #endif
 
+    // Bound the memory held by the jobs in flight.
+    Long staging_bytes = 0;
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        Box bx = strip_ghost ? mfi.validbox() : mfi.fabbox();
+        staging_bytes += bx.numPts() * ncomp * static_cast<Long>(sizeof(Real));
+    }
+    AsyncOut::ReserveStaging(staging_bytes);
+
     auto myfabs = std::make_shared<Vector<FArrayBox> >();
     for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
         Box bx = strip_ghost ? mfi.validbox() : mfi.fabbox();
@@ -2420,6 +3258,9 @@ VisMF::AsyncWriteDoit (const FabArray<FArrayBox>& mf, const std::string& mf_name
         ofs.flush();
         ofs.close();
 
+        myfabs->clear();
+        AsyncOut::ReleaseStaging(staging_bytes);
+
         AsyncOut::Notify();  // Notify others I am done
     });
 }
@@ -396,9 +396,20 @@ MLABecLaplacian::Fsmooth (int amrlev, int mglev, MultiFab& sol, const MultiFab&
 {
     BL_PROFILE("MLABecLaplacian::Fsmooth()");
 
-    bool regular_coarsening = true;
-    if (amrlev == 0 && mglev > 0) {
-        regular_coarsening = mg_coarsen_ratio_vec[mglev-1] == mg_coarsen_ratio;
+    if (!m_overset_mask[amrlev][mglev])
+    {
+        if (m_smoother == MLSmoother::line_gs || m_smoother == MLSmoother::zebra_plane)
+        {
+            FsmoothLine(amrlev, mglev, sol, rhs, redblack, m_smoother);
+            return;
+        }
+        else if (amrlev == 0 && mglev > 0 && mg_coarsen_ratio_vec[mglev-1] != mg_coarsen_ratio)
+        {
+            // Point relaxation does not smooth in the directions that
+            // were not coarsened.  Relax lines along them instead.
+            FsmoothLine(amrlev, mglev, sol, rhs, redblack, MLSmoother::line_gs);
+            return;
+        }
     }
 
     const MultiFab& acoef = m_a_coeffs[amrlev][mglev];
@@ -492,7 +503,7 @@ MLABecLaplacian::Fsmooth (int amrlev, int mglev, MultiFab& sol, const MultiFab&
                              AMREX_D_DECL(f1fab,f3fab,f5fab),
                              osm, vbx, redblack, nc);
             });
-        } else if (regular_coarsening) {
+        } else {
             AMREX_LAUNCH_HOST_DEVICE_FUSIBLE_LAMBDA ( tbx, thread_box,
             {
                 abec_gsrb(thread_box, solnfab, rhsfab, alpha, afab,
@@ -504,20 +515,130 @@ MLABecLaplacian::Fsmooth (int amrlev, int mglev, MultiFab& sol, const MultiFab&
                           AMREX_D_DECL(f1fab,f3fab,f5fab),
                           vbx, redblack, nc);
             });
+        }
+    }
+}
+
+int
+MLABecLaplacian::lineSmootherDir (int amrlev, int mglev, MLSmoother smoother) const
+{
+    if (m_smoother_dir >= 0 && smoother == m_smoother) return m_smoother_dir;
+
+    // Lines go along the most strongly coupled direction (i.e., the
+    // smallest cell size), whereas planes are normal to the most weakly
+    // coupled direction.
+    const Real* dxinv = m_geom[amrlev][mglev].InvCellSize();
+    int dir = 0;
+    for (int idim = 1; idim < AMREX_SPACEDIM; ++idim) {
+        if (smoother == MLSmoother::line_gs) {
+            if (dxinv[idim] > dxinv[dir]) dir = idim;
         } else {
-            Gpu::LaunchSafeGuard lsg(false); // xxxxx gpu todo
-            // line solve does not with with GPU
-            AMREX_LAUNCH_HOST_DEVICE_LAMBDA ( tbx, thread_box,
-            {
-                abec_gsrb_with_line_solve(thread_box, solnfab, rhsfab, alpha, afab,
-                                          AMREX_D_DECL(dhx, dhy, dhz),
-                                          AMREX_D_DECL(bxfab, byfab, bzfab),
-                                          AMREX_D_DECL(m0,m2,m4),
-                                          AMREX_D_DECL(m1,m3,m5),
-                                          AMREX_D_DECL(f0fab,f2fab,f4fab),
-                                          AMREX_D_DECL(f1fab,f3fab,f5fab),
-                                          vbx, redblack, nc);
-            });
+            if (dxinv[idim] < dxinv[dir]) dir = idim;
+        }
+    }
+    return dir;
+}
+
+void
+MLABecLaplacian::FsmoothLine (int amrlev, int mglev, MultiFab& sol, const MultiFab& rhs,
+                              int redblack, MLSmoother smoother) const
+{
+    BL_PROFILE("MLABecLaplacian::FsmoothLine()");
+
+    const MultiFab& acoef = m_a_coeffs[amrlev][mglev];
+    const auto& undrrelxr = m_undrrelxr[amrlev][mglev];
+    const auto& maskvals  = m_maskvals [amrlev][mglev];
+
+    const int nc = getNComp();
+    const Real* h = m_geom[amrlev][mglev].CellSize();
+    GpuArray<Real,AMREX_SPACEDIM> dh;
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        dh[idim] = m_b_scalar/(h[idim]*h[idim]);
+    }
+    const Real alpha = m_a_scalar;
+
+    const int dir = lineSmootherDir(amrlev, mglev, smoother);
+    const bool plane = (smoother == MLSmoother::zebra_plane);
+
+    // Each tile must contain whole lines (or whole planes).
+    IntVect tilesize = FabArrayBase::mfiter_tile_size;
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        if ((idim == dir) != plane) tilesize[idim] = 1024000;
+    }
+
+    MFItInfo mfi_info;
+    mfi_info.EnableTiling(tilesize).SetDynamic(true);
+
+    // The line solves run on the host.
+    Gpu::streamSynchronize();
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel
+#endif
+    for (MFIter mfi(sol,mfi_info); mfi.isValid(); ++mfi)
+    {
+        const Box& tbx = mfi.tilebox();
+        const Box& vbx = mfi.validbox();
+        const auto& solnfab = sol.array(mfi);
+        const auto& rhsfab  = rhs.const_array(mfi);
+        const auto& afab    = acoef.const_array(mfi);
+
+        GpuArray<Array4<Real const>,AMREX_SPACEDIM> bfab;
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            bfab[idim] = m_b_coeffs[amrlev][mglev][idim].const_array(mfi);
+        }
+        GpuArray<Array4<int const>,2*AMREX_SPACEDIM> mfab;
+        GpuArray<Array4<Real const>,2*AMREX_SPACEDIM> ffab;
+        for (OrientationIter oitr; oitr; ++oitr) {
+            const Orientation ori = oitr();
+            mfab[ori] = maskvals[ori].array(mfi);
+            ffab[ori] = undrrelxr[ori].array(mfi);
+        }
+
+        FArrayBox ws(tbx, plane ? 2+nc : 2, The_Cpu_Arena());
+        const auto& gam = ws.array(0);
+        const auto& u   = ws.array(1);
+
+        if (!plane)
+        {
+            // Red-black ordering of the lines, so that lines of the same
+            // color are not coupled.
+            abec_line_solve(dir, tbx, solnfab, sol.const_array(mfi), rhsfab, alpha, afab,
+                            dh, bfab, mfab, ffab, gam, u, vbx, nc,
+                            [=] (int i, int j, int k) noexcept -> bool
+                            {
+                                return (i+j+k+redblack)%2 == 0;
+                            });
+        }
+        else
+        {
+            // Zebra ordering of the planes normal to dir.  Each plane is
+            // solved approximately by m_plane_sweeps zebra line sweeps in
+            // each of the in-plane directions.  Since cells are updated
+            // more than once, the values used to fill the ghost cells are
+            // saved.
+            ws.copy<RunOn::Host>(sol[mfi], tbx, 0, tbx, 2, nc);
+            const auto& sol0 = ws.const_array(2);
+            for (int isweep = 0; isweep < m_plane_sweeps; ++isweep) {
+                for (int ldir = 0; ldir < AMREX_SPACEDIM; ++ldir) {
+                    if (ldir == dir) continue;
+                    int qdir = -1;
+                    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                        if (idim != dir && idim != ldir) qdir = idim;
+                    }
+                    for (int zebra = 0; zebra < 2; ++zebra) {
+                        abec_line_solve(ldir, tbx, solnfab, sol0, rhsfab, alpha, afab,
+                                        dh, bfab, mfab, ffab, gam, u, vbx, nc,
+                                        [=] (int i, int j, int k) noexcept -> bool
+                                        {
+                                            const IntVect iv(AMREX_D_DECL(i,j,k));
+                                            return (iv[dir]+redblack)%2 == 0
+                                                && (qdir < 0 || (iv[qdir]+zebra)%2 == 0);
+                                        });
+                        if (qdir < 0) break;
+                    }
+                }
+            }
         }
     }
 }
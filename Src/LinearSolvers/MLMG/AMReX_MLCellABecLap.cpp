@@ -139,6 +139,21 @@ MLCellABecLap::define (const Vector<Geometry>& a_geom,
     }
 }
 
+bool
+MLCellABecLap::supportsSmoother (MLSmoother s) const noexcept
+{
+    if (s == MLSmoother::chebyshev) {
+        // Overset cells must not be relaxed.
+        for (const auto& v : m_overset_mask) {
+            for (const auto& p : v) {
+                if (p) return false;
+            }
+        }
+        return true;
+    }
+    return MLCellLinOp::supportsSmoother(s);
+}
+
 void
 MLCellABecLap::prepareForSolve ()
 {
@@ -1,6 +1,7 @@
 
 #include <AMReX_Utility.H>
 #include <AMReX_MLLinOp.H>
+#include <AMReX_MLLinOp_K.H>
 #include <AMReX_MLCellLinOp.H>
 #include <AMReX_ParmParse.H>
 #include <AMReX_Machine.H>
@@ -17,6 +18,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <limits>
 #include <set>
 #include <unordered_map>
 
@@ -126,6 +128,19 @@ MLLinOp::MLLinOp () {}
 
 MLLinOp::~MLLinOp () {}
 
+void
+MLLinOp::setSmoother (MLSmoother s, int line_dir)
+{
+    if (!supportsSmoother(s)) {
+        amrex::Abort("MLLinOp::setSmoother: smoother not supported by " + name());
+    }
+    AMREX_ALWAYS_ASSERT(line_dir < AMREX_SPACEDIM);
+    m_smoother = s;
+    m_smoother_dir = line_dir;
+    m_cheb_invdiag.clear();
+    m_cheb_lambda.clear();
+}
+
 void
 MLLinOp::define (const Vector<Geometry>& a_geom,
                  const Vector<BoxArray>& a_grids,
@@ -277,8 +292,10 @@ MLLinOp::defineGrids (const Vector<Geometry>& a_geom,
     {
         Vector<Box> domainboxes;
         Vector<Box> boundboxes;
+        Vector<IntVect> ratios;
         Box dbx = m_geom[0][0].Domain();
         Box bbx = aggbox;
+        IntVect rr(1);
         Real nbxs = static_cast<Real>(m_grids[0][0].size());
         Real threshold_npts = static_cast<Real>(AMREX_D_TERM(info.agg_grid_size,
                                                              *info.agg_grid_size,
@@ -286,91 +303,41 @@ MLLinOp::defineGrids (const Vector<Geometry>& a_geom,
         Vector<int> agg_flag;
         domainboxes.push_back(dbx);
         boundboxes.push_back(bbx);
+        ratios.push_back(rr);
         agg_flag.push_back(false); 
 
-#if (AMREX_SPACEDIM > 1)
-        if (info.do_semicoarsening) 
-	{   
-	    int num_semicoarsening_level = 0;
-            IntVect rr_0(AMREX_D_DECL(mg_coarsen_ratio,1,1));
-            bool is_coarsenable_x = ( dbx.coarsenable(rr_0, mg_domain_min_width) &&
-                                      bbx.coarsenable(rr_0, mg_box_min_width));
-            IntVect rr_1(AMREX_D_DECL(1,mg_coarsen_ratio,1));
-            bool is_coarsenable_y = ( dbx.coarsenable(rr_1, mg_domain_min_width) &&
-                                      bbx.coarsenable(rr_1, mg_box_min_width));
-#if (AMREX_SPACEDIM == 3)
-            IntVect rr_2(AMREX_D_DECL(1,1,mg_coarsen_ratio));
-            bool is_coarsenable_z = ( dbx.coarsenable(rr_2, mg_domain_min_width) &&
-                                      bbx.coarsenable(rr_2, mg_box_min_width));
-#endif
-	    IntVect rr_vec(mg_coarsen_ratio);
-#if (AMREX_SPACEDIM == 2)
-            while ( is_coarsenable_x || is_coarsenable_y )
-#endif
-#if (AMREX_SPACEDIM == 3)
-            while ( is_coarsenable_x || is_coarsenable_y || is_coarsenable_z )
-#endif
-	    {
-#if (AMREX_SPACEDIM >= 2)
-                int r0 = (is_coarsenable_x) ? mg_coarsen_ratio : 1;
-                int r1 = (is_coarsenable_y) ? mg_coarsen_ratio : 1;
-                rr_vec[0] = r0;
-                rr_vec[1] = r1;
-#if (AMREX_SPACEDIM == 3)
-                int r2 = (is_coarsenable_z) ? mg_coarsen_ratio : 1;
-                rr_vec[2] = r2;
-#endif
-#endif
-                dbx.coarsen(rr_vec);
-                domainboxes.push_back(dbx);
-                bbx.coarsen(rr_vec);
-                boundboxes.push_back(bbx);
-                bool to_agg = (bbx.d_numPts() / nbxs) < 0.999*threshold_npts;
-                agg_flag.push_back(to_agg);
-
-                is_coarsenable_x = ( dbx.coarsenable(rr_0, mg_domain_min_width) &&
-                                     bbx.coarsenable(rr_0, mg_box_min_width));
-#if (AMREX_SPACEDIM >= 2)
-                is_coarsenable_y = ( dbx.coarsenable(rr_1, mg_domain_min_width) &&
-                                     bbx.coarsenable(rr_1, mg_box_min_width));
-#if (AMREX_SPACEDIM == 3)
-                is_coarsenable_z = ( dbx.coarsenable(rr_2, mg_domain_min_width) &&
-                                     bbx.coarsenable(rr_2, mg_box_min_width));
-#endif
-#endif
-#if (AMREX_SPACEDIM == 2)
-		if (!(is_coarsenable_x && is_coarsenable_y))
-#endif
-#if (AMREX_SPACEDIM == 3)
-                if (!(is_coarsenable_x && is_coarsenable_y && is_coarsenable_z))
-#endif
-		{
-		    num_semicoarsening_level++;    
-		    if (num_semicoarsening_level > info.max_semicoarsening_level) break;
-		}
-	    }
+        int num_semicoarsening_level = 0;
+        while (true)
+        {
+            Array<bool,AMREX_SPACEDIM> coarsenable;
+            Array<Real,AMREX_SPACEDIM> dx;
+            for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                IntVect r(1);
+                r[idim] = mg_coarsen_ratio;
+                coarsenable[idim] = dbx.coarsenable(r, mg_domain_min_width)
+                    &&              bbx.coarsenable(r, mg_box_min_width);
+                dx[idim] = a_geom[0].CellSize(idim) * rr[idim];
+            }
+            const IntVect r = mgNextRatio(info.do_semicoarsening, coarsenable, dx);
+            if (r == IntVect::TheUnitVector()) break;
+            if (r != IntVect(mg_coarsen_ratio)) {
+                if (++num_semicoarsening_level > info.max_semicoarsening_level) break;
+            }
 
+            rr *= r;
+            dbx.coarsen(r);
+            domainboxes.push_back(dbx);
+            bbx.coarsen(r);
+            boundboxes.push_back(bbx);
+            ratios.push_back(rr);
+            bool to_agg = (bbx.d_numPts() / nbxs) < 0.999*threshold_npts;
+            agg_flag.push_back(to_agg);
         }
-	else 
-#endif
-	{
-            while (    dbx.coarsenable(mg_coarsen_ratio,mg_domain_min_width)
-                   && bbx.coarsenable(mg_coarsen_ratio,mg_box_min_width))
-            {
-                dbx.coarsen(mg_coarsen_ratio);
-                domainboxes.push_back(dbx);
-                bbx.coarsen(mg_coarsen_ratio);
-                boundboxes.push_back(bbx);
-                bool to_agg = (bbx.d_numPts() / nbxs) < 0.999*threshold_npts;
-                agg_flag.push_back(to_agg);
-            }
-	}
 
         int first_agglev = std::distance(agg_flag.begin(),
                                          std::find(agg_flag.begin(),agg_flag.end(),1));
         int nmaxlev = std::min(static_cast<int>(domainboxes.size()),
                                info.max_coarsening_level + 1);
-        int rr = mg_coarsen_ratio;
 
         // We may have to agglomerate earlier because the original
         // BoxArray has to be coarsenable to the first agglomerated
@@ -379,8 +346,8 @@ MLLinOp::defineGrids (const Vector<Geometry>& a_geom,
         // average_down more general).
         int last_coarsenableto_lev = 0;
         for (int lev = std::min(nmaxlev,first_agglev); lev >= 1; --lev) {
-            int ratio = static_cast<int>(std::pow(rr,lev));
-            if (a_grids[0].coarsenable(ratio, mg_box_min_width)) {
+            if (lev < static_cast<int>(ratios.size()) &&
+                a_grids[0].coarsenable(ratios[lev], mg_box_min_width)) {
                 last_coarsenableto_lev = lev;
                 break;
             }
@@ -400,14 +367,12 @@ MLLinOp::defineGrids (const Vector<Geometry>& a_geom,
 
             for (int lev = 1; lev < last_coarsenableto_lev; ++lev)
             {
-                m_geom[0].emplace_back(amrex::coarsen(a_geom[0].Domain(),rr),rb,coord,is_per);
+                m_geom[0].emplace_back(domainboxes[lev],rb,coord,is_per);
                 
                 m_grids[0].push_back(a_grids[0]);
-                m_grids[0].back().coarsen(rr);
+                m_grids[0].back().coarsen(ratios[lev]);
             
                 m_dmap[0].push_back(a_dmap[0]);
-                
-                rr *= mg_coarsen_ratio;
             }
 
             for (int lev = last_coarsenableto_lev; lev < nmaxlev; ++lev)
@@ -427,7 +392,7 @@ MLLinOp::defineGrids (const Vector<Geometry>& a_geom,
     }
     else
     {
-        int rr = mg_coarsen_ratio;
+        IntVect rr(1);
         Real avg_npts = 0.0;
         if (info.do_consolidation) {
             avg_npts = static_cast<Real>(a_grids[0].d_numPts()) / static_cast<Real>(ParallelContext::NProcsSub());
@@ -438,11 +403,26 @@ MLLinOp::defineGrids (const Vector<Geometry>& a_geom,
             }
         }
 
-        // Regular coarsening
-        while (m_num_mg_levels[0] < info.max_coarsening_level + 1
-               && a_geom[0].Domain().coarsenable(rr, mg_domain_min_width)
-               && a_grids[0].coarsenable(rr, mg_box_min_width))
+        int num_semicoarsening_level = 0;
+        while (m_num_mg_levels[0] < info.max_coarsening_level + 1)
         {
+            Array<bool,AMREX_SPACEDIM> coarsenable;
+            Array<Real,AMREX_SPACEDIM> dx;
+            for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                IntVect r = rr;
+                r[idim] *= mg_coarsen_ratio;
+                coarsenable[idim] = a_geom[0].Domain().coarsenable(r, mg_domain_min_width)
+                    &&              a_grids[0].coarsenable(r, mg_box_min_width);
+                dx[idim] = a_geom[0].CellSize(idim) * rr[idim];
+            }
+            const IntVect r = mgNextRatio(info.do_semicoarsening, coarsenable, dx);
+            if (r == IntVect::TheUnitVector()) break;
+            if (r != IntVect(mg_coarsen_ratio)) {
+                if (++num_semicoarsening_level > info.max_semicoarsening_level) break;
+            }
+
+            rr *= r;
+
             m_geom[0].emplace_back(amrex::coarsen(a_geom[0].Domain(),rr),rb,coord,is_per);
 
             m_grids[0].push_back(a_grids[0]);
@@ -450,7 +430,8 @@ MLLinOp::defineGrids (const Vector<Geometry>& a_geom,
 
             if (info.do_consolidation)
             {
-                if (avg_npts/(AMREX_D_TERM(rr,*rr,*rr)) < 0.999*consolidation_threshold)
+                if (avg_npts/static_cast<Real>(AMREX_D_TERM(rr[0],*rr[1],*rr[2]))
+                    < 0.999*consolidation_threshold)
                 {
                     coned = true;
                     con_lev = m_dmap[0].size();
@@ -467,97 +448,6 @@ MLLinOp::defineGrids (const Vector<Geometry>& a_geom,
             }
             
             ++(m_num_mg_levels[0]);
-            rr *= mg_coarsen_ratio;
-        }
-
-        if (info.do_semicoarsening)
-        {
-            int num_semicoarsening_level = 1;
-            // Semi-coarsening  -- by the time we get here we know we can't coarsen isotropically any more
-#if (AMREX_SPACEDIM >= 2)
-            IntVect rr_0(AMREX_D_DECL(rr,1,1));
-            bool is_coarsenable_x = ( a_geom[0].Domain().coarsenable(rr_0, mg_domain_min_width) &&
-                                      a_grids[0].coarsenable(rr_0, mg_box_min_width));
-            IntVect rr_1(AMREX_D_DECL(1,rr,1));
-            bool is_coarsenable_y = ( a_geom[0].Domain().coarsenable(rr_1, mg_domain_min_width) &&
-                                      a_grids[0].coarsenable(rr_1, mg_box_min_width));
-#endif
-#if (AMREX_SPACEDIM == 3)
-            IntVect rr_2(AMREX_D_DECL(1,1,rr));
-            bool is_coarsenable_z = ( a_geom[0].Domain().coarsenable(rr_2, mg_domain_min_width) &&
-                                      a_grids[0].coarsenable(rr_2, mg_box_min_width));
-#endif
-
-#if (AMREX_SPACEDIM == 2)
-            if (is_coarsenable_x || is_coarsenable_y)
-#endif
-#if (AMREX_SPACEDIM == 3)
-            if (is_coarsenable_x || is_coarsenable_y || is_coarsenable_z)
-#endif
-            {
-                IntVect rr_vec(rr/mg_coarsen_ratio);
-#if (AMREX_SPACEDIM == 2)
-                while ( (num_semicoarsening_level < info.max_semicoarsening_level + 1) &&
-			(m_num_mg_levels[0] < info.max_coarsening_level + 1) &&
-                        (is_coarsenable_x || is_coarsenable_y ) )
-#endif
-#if (AMREX_SPACEDIM == 3)
-                while ( (num_semicoarsening_level < info.max_semicoarsening_level + 1) &&
-		        (m_num_mg_levels[0] < info.max_coarsening_level + 1) &&
-                        (is_coarsenable_x || is_coarsenable_y || is_coarsenable_z) )
-#endif
-                {
-#if (AMREX_SPACEDIM >= 2)
-                    int r0 = (is_coarsenable_x) ? rr_vec[0]*mg_coarsen_ratio : rr_vec[0];
-                    int r1 = (is_coarsenable_y) ? rr_vec[1]*mg_coarsen_ratio : rr_vec[1];
-                    rr_vec[0] = r0;
-                    rr_vec[1] = r1;
-#if (AMREX_SPACEDIM == 3)
-                    int r2 = (is_coarsenable_z) ? rr_vec[2]*mg_coarsen_ratio : rr_vec[2];
-                    rr_vec[2] = r2;
-#endif
-#endif
-                    m_geom[0].emplace_back(amrex::coarsen(a_geom[0].Domain(),rr_vec),rb,coord,is_per);
-                    m_grids[0].push_back(a_grids[0]);
-                    m_grids[0].back().coarsen(rr_vec);
-
-                    if (info.do_consolidation)
-                    {
-                        if (avg_npts/(AMREX_D_TERM(rr,*rr,*rr)) < 0.999*consolidation_threshold)
-                        {
-                            coned = true;
-                            con_lev = m_dmap[0].size();
-                            m_dmap[0].push_back(DistributionMapping());
-                        }
-                        else
-                        {
-                            m_dmap[0].push_back(m_dmap[0].back());
-                        }
-                    }
-                    else
-                    {
-                        m_dmap[0].push_back(a_dmap[0]);
-                    }
-                    ++(m_num_mg_levels[0]);
-                    ++num_semicoarsening_level;
-
-#if (AMREX_SPACEDIM >= 2)
-                    IntVect rrr_0(AMREX_D_DECL(rr_vec[0]*mg_coarsen_ratio, 1, 1));
-                    is_coarsenable_x = ( a_geom[0].Domain().coarsenable(rrr_0, mg_domain_min_width) &&
-                                         a_grids[0].coarsenable(rrr_0, mg_box_min_width));
-                    IntVect rrr_1(AMREX_D_DECL(1, rr_vec[1]*mg_coarsen_ratio, 1));
-                    is_coarsenable_y = ( a_geom[0].Domain().coarsenable(rrr_1, mg_domain_min_width) &&
-                                         a_grids[0].coarsenable(rrr_1, mg_box_min_width));
-
-#if (AMREX_SPACEDIM == 3)
-                    IntVect rrr_2(AMREX_D_DECL(1,1,rr_vec[2]*mg_coarsen_ratio));
-                    is_coarsenable_z = ( a_geom[0].Domain().coarsenable(rrr_2, mg_domain_min_width) &&
-                                         a_grids[0].coarsenable(rrr_2, mg_box_min_width));
-#endif
-#endif
-
-                }
-            }
         }
     }
 
@@ -565,6 +455,9 @@ MLLinOp::defineGrids (const Vector<Geometry>& a_geom,
         const Box& fine_domain = m_geom[0][mglev].Domain();
         const Box& crse_domain = m_geom[0][mglev+1].Domain();
         mg_coarsen_ratio_vec.push_back(fine_domain.length()/crse_domain.length());
+        if (mg_coarsen_ratio_vec.back() != mg_coarsen_ratio) {
+            m_do_semicoarsening = true;
+        }
     }
 
     for (int amrlev = 0; amrlev < m_num_amr_levels; ++amrlev) {
@@ -627,6 +520,39 @@ MLLinOp::defineGrids (const Vector<Geometry>& a_geom,
     }
 }
 
+IntVect
+MLLinOp::mgNextRatio (bool semicoarsening, const Array<bool,AMREX_SPACEDIM>& coarsenable,
+                      const Array<Real,AMREX_SPACEDIM>& dx) noexcept
+{
+    IntVect r(1);
+    if (!semicoarsening)
+    {
+        bool all = true;
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            all = all && coarsenable[idim];
+        }
+        if (all) r = IntVect(mg_coarsen_ratio);
+    }
+    else
+    {
+        // Coarsen the directions whose cell size is within a factor of
+        // the ratio of the smallest one.  With anisotropic cells this
+        // coarsens the fine directions until the cells are (nearly)
+        // isotropic, and directions that can no longer be coarsened
+        // (e.g., the thin direction of a slab) are left alone.
+        Real dxmin = std::numeric_limits<Real>::max();
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            if (coarsenable[idim]) dxmin = std::min(dxmin, dx[idim]);
+        }
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            if (coarsenable[idim] && dx[idim] < Real(0.999*mg_coarsen_ratio)*dxmin) {
+                r[idim] = mg_coarsen_ratio;
+            }
+        }
+    }
+    return r;
+}
+
 void
 MLLinOp::defineAuxData ()
 {
@@ -654,6 +580,149 @@ MLLinOp::make (Vector<Vector<MultiFab> >& mf, int nc, int ng) const
     }
 }
 
+void
+MLLinOp::setupChebyshev (bool force)
+{
+    if (!force && !m_cheb_invdiag.empty()) return;
+
+    BL_PROFILE("MLLinOp::setupChebyshev()");
+
+    AMREX_ALWAYS_ASSERT(m_cheb_degree >= 1 && m_cheb_eigen_ratio > 1.0);
+
+    const int ncomp = getNComp();
+    constexpr int npower = 10;
+
+    m_cheb_invdiag.clear();
+    m_cheb_lambda.clear();
+    m_cheb_invdiag.resize(m_num_amr_levels);
+    m_cheb_lambda.resize(m_num_amr_levels);
+
+    for (int amrlev = 0; amrlev < m_num_amr_levels; ++amrlev)
+    {
+        m_cheb_invdiag[amrlev].resize(m_num_mg_levels[amrlev]);
+        m_cheb_lambda[amrlev].resize(m_num_mg_levels[amrlev]);
+        for (int mglev = 0; mglev < m_num_mg_levels[amrlev]; ++mglev)
+        {
+            const BoxArray& ba = amrex::convert(m_grids[amrlev][mglev], m_ixtype);
+            const DistributionMapping& dm = m_dmap[amrlev][mglev];
+            const auto& factory = *m_factory[amrlev][mglev];
+            MultiFab x(ba, dm, ncomp, 1, MFInfo(), factory);
+            MultiFab Ax(ba, dm, ncomp, 0, MFInfo(), factory);
+            m_cheb_invdiag[amrlev][mglev].reset(new MultiFab(ba, dm, ncomp, 0, MFInfo(), factory));
+            MultiFab& invdiag = *m_cheb_invdiag[amrlev][mglev];
+
+            compInvDiag(amrlev, mglev, invdiag);
+
+            x.setVal(0.0);
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+            for (MFIter mfi(x,TilingIfNotGPU()); mfi.isValid(); ++mfi)
+            {
+                const Box& bx = mfi.tilebox();
+                Array4<Real> const& xa = x.array(mfi);
+                amrex::ParallelFor(bx, ncomp, [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
+                {
+                    xa(i,j,k,n) = mllinop_hash(i,j,k,n);
+                });
+            }
+
+            // Power iteration for the largest eigenvalue of D^{-1}A
+            Real lambda = 0.0;
+            for (int it = 0; it < npower; ++it)
+            {
+                const Real xnorm = std::sqrt(MultiFab::Dot(x, 0, x, 0, ncomp, 0));
+                if (xnorm == 0.0) break;
+                x.mult(Real(1.0)/xnorm, 0, ncomp, 0);
+                apply(amrlev, mglev, Ax, x, BCMode::Homogeneous, StateMode::Correction);
+                MultiFab::Multiply(Ax, invdiag, 0, 0, ncomp, 0);
+                lambda = std::sqrt(MultiFab::Dot(Ax, 0, Ax, 0, ncomp, 0));
+                MultiFab::Copy(x, Ax, 0, 0, ncomp, 0);
+            }
+            // The power iteration underestimates the eigenvalue.
+            m_cheb_lambda[amrlev][mglev] = (lambda > 0.0) ? Real(1.1)*lambda : Real(1.0);
+
+            if (verbose >= 2) {
+                amrex::Print() << "MLLinOp::setupChebyshev(): AMR level " << amrlev
+                               << " MG level " << mglev << " lambda_max = "
+                               << m_cheb_lambda[amrlev][mglev] << "\n";
+            }
+        }
+    }
+}
+
+void
+MLLinOp::compInvDiag (int amrlev, int mglev, MultiFab& invdiag) const
+{
+    // normalize divides by the diagonal used by the Jacobi preconditioner
+    // of the bottom solvers.
+    invdiag.setVal(1.0);
+    normalize(amrlev, mglev, invdiag);
+}
+
+void
+MLLinOp::chebyshevSmooth (int amrlev, int mglev, MultiFab& sol, const MultiFab& rhs) const
+{
+    BL_PROFILE("MLLinOp::chebyshevSmooth()");
+
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!m_cheb_invdiag.empty(),
+                                     "MLLinOp::chebyshevSmooth: setupChebyshev not called");
+
+    const int ncomp = getNComp();
+    const MultiFab& invdiag = *m_cheb_invdiag[amrlev][mglev];
+    AMREX_ASSERT(amrex::isMFIterSafe(sol, invdiag));
+
+    const Real lambda_max = m_cheb_lambda[amrlev][mglev];
+    const Real lambda_min = lambda_max / m_cheb_eigen_ratio;
+    const Real theta = 0.5*(lambda_max + lambda_min);
+    const Real delta = 0.5*(lambda_max - lambda_min);
+    const Real sigma = theta / delta;
+    Real rho = Real(1.0) / sigma;
+
+    MultiFab Ax(sol.boxArray(), sol.DistributionMap(), ncomp, 0, MFInfo(), sol.Factory());
+    MultiFab dx(sol.boxArray(), sol.DistributionMap(), ncomp, 0, MFInfo(), sol.Factory());
+
+    // Three-term recurrence of the Chebyshev polynomial in D^{-1}A.
+    // Each step needs one application of A and thus one FillBoundary.
+    for (int m = 0; m < m_cheb_degree; ++m)
+    {
+        apply(amrlev, mglev, Ax, sol, BCMode::Homogeneous, StateMode::Solution);
+
+        Real a, b;
+        if (m == 0) {
+            a = 0.0;
+            b = Real(1.0) / theta;
+        } else {
+            const Real rho_new = Real(1.0) / (Real(2.0)*sigma - rho);
+            a = rho_new * rho;
+            b = Real(2.0) * rho_new / delta;
+            rho = rho_new;
+        }
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+        for (MFIter mfi(sol,TilingIfNotGPU()); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.tilebox();
+            Array4<Real> const& xa = sol.array(mfi);
+            Array4<Real> const& da = dx.array(mfi);
+            Array4<Real const> const& ba = rhs.const_array(mfi);
+            Array4<Real const> const& axa = Ax.const_array(mfi);
+            Array4<Real const> const& dia = invdiag.const_array(mfi);
+            amrex::ParallelFor(bx, ncomp, [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
+            {
+                Real d = b * dia(i,j,k,n) * (ba(i,j,k,n) - axa(i,j,k,n));
+                if (m > 0) d += a * da(i,j,k,n);
+                da(i,j,k,n) = d;
+                xa(i,j,k,n) += d;
+            });
+        }
+    }
+
+    nodalSync(amrlev, mglev, sol);
+}
+
 void
 MLLinOp::setDomainBC (const Array<BCType,AMREX_SPACEDIM>& a_lobc,
                       const Array<BCType,AMREX_SPACEDIM>& a_hibc) noexcept
@@ -3,6 +3,7 @@
 #include <AMReX_VisMF.H>
 #include <AMReX_BC_TYPES.H>
 #include <AMReX_MLMG_K.H>
+#include <AMReX_Exception.H>
 #include <AMReX_MLABecLaplacian.H>
 
 #ifdef AMREX_USE_PETSC
@@ -74,6 +75,8 @@ MLMG::solve (const Vector<MultiFab*>& a_sol, const Vector<MultiFab const*>& a_rh
     bool is_nsolve = linop.m_parent;
 
     auto solve_start_time = amrex::second();
+    const FabArrayBase::CommStats comm_stats0 = FabArrayBase::m_comm_stats;
+    bool converged = false;
 
     Real& composite_norminf = m_final_resnorm0;
 
@@ -115,12 +118,12 @@ MLMG::solve (const Vector<MultiFab*>& a_sol, const Vector<MultiFab const*>& a_rh
 
     if (!is_nsolve && resnorm0 <= res_target) {
         composite_norminf = resnorm0;
+        converged = true;
         if (verbose >= 1) {
             amrex::Print() << "MLMG: No iterations needed\n";
         }
     } else {
         auto iter_start_time = amrex::second();
-        bool converged = false;
 
         const int niters = do_fixed_number_of_iters ? do_fixed_number_of_iters : max_iters;
         for (int iter = 0; iter < niters; ++iter)
@@ -177,6 +180,9 @@ MLMG::solve (const Vector<MultiFab*>& a_sol, const Vector<MultiFab const*>& a_rh
                                      << composite_norminf << ", "
                                      << composite_norminf/max_norm << "\n";
                   }
+                  if (throw_exception) {
+                      throw RuntimeError("MLMG failing so lets stop here");
+                  }
 		  amrex::Abort("MLMG failing so lets stop here");
               }
             }
@@ -189,6 +195,9 @@ MLMG::solve (const Vector<MultiFab*>& a_sol, const Vector<MultiFab const*>& a_rh
                                << composite_norminf << ", "
                                << composite_norminf/max_norm << "\n";
             }
+            if (throw_exception) {
+                throw RuntimeError("MLMG failed");
+            }
             amrex::Abort("MLMG failed");
         }
         timer[iter_time] = amrex::second() - iter_start_time;
@@ -204,15 +213,51 @@ MLMG::solve (const Vector<MultiFab*>& a_sol, const Vector<MultiFab const*>& a_rh
     }
 
     timer[solve_time] = amrex::second() - solve_start_time;
+    timer[comm_wait_time] = FabArrayBase::m_comm_stats.wait_time - comm_stats0.wait_time;
+
+    Vector<Long> comm_counts{FabArrayBase::m_comm_stats.num_sends  - comm_stats0.num_sends,
+                             FabArrayBase::m_comm_stats.bytes_sent - comm_stats0.bytes_sent};
+    // Without the opt-in, only what is printed is reduced, as before.
+    if (collect_stats || verbose >= 1) {
+        ParallelAllReduce::Max<double>(timer.data(), timer.size(),
+                                       ParallelContext::CommunicatorSub());
+    }
+    if (collect_stats || verbose >= 2) {
+        ParallelAllReduce::Sum<Long>(comm_counts.data(), comm_counts.size(),
+                                     ParallelContext::CommunicatorSub());
+    }
+
+    m_stats.num_iters = getNumIters();
+    m_stats.converged = converged;
+    m_stats.rhs_norm = m_rhsnorm0;
+    m_stats.init_residual = m_init_resnorm0;
+    m_stats.final_residual = m_final_resnorm0;
+    m_stats.residual_history = m_iter_fine_resnorm0;
+    m_stats.bottom_iters = m_niters_cg;
+    m_stats.solve_time = timer[solve_time];
+    m_stats.iter_time = timer[iter_time];
+    m_stats.smooth_time = timer[smooth_time];
+    m_stats.restrict_time = timer[restrict_time];
+    m_stats.interp_time = timer[interp_time];
+    m_stats.residual_time = timer[residual_time];
+    m_stats.bottom_time = timer[bottom_time];
+    m_stats.comm_wait_time = timer[comm_wait_time];
+    m_stats.comm_messages = comm_counts[0];
+    m_stats.comm_bytes = comm_counts[1];
+
     if (verbose >= 1) {
-        ParallelReduce::Max<double>(timer.data(), timer.size(), 0,
-                                    ParallelContext::CommunicatorSub());
-        if (ParallelContext::MyProcSub() == 0)
-        {
-            amrex::AllPrint() << "MLMG: Timers: Solve = " << timer[solve_time]
-                              << " Iter = " << timer[iter_time]
-                              << " Bottom = " << timer[bottom_time] << "\n";
-        }
+        amrex::Print() << "MLMG: Timers: Solve = " << timer[solve_time]
+                       << " Iter = " << timer[iter_time]
+                       << " Bottom = " << timer[bottom_time] << "\n";
+    }
+    if (verbose >= 2) {
+        amrex::Print() << "MLMG: Timers: Smooth = " << timer[smooth_time]
+                       << " Restriction = " << timer[restrict_time]
+                       << " Interpolation = " << timer[interp_time]
+                       << " Residual = " << timer[residual_time]
+                       << " Comm. wait = " << timer[comm_wait_time] << "\n"
+                       << "MLMG: Communication: messages = " << comm_counts[0]
+                       << " bytes = " << comm_counts[1] << "\n";
     }
 
     ++solve_called;
@@ -264,7 +309,9 @@ void MLMG::oneIter (int iter)
     for (int alev = 1; alev <= finest_amr_lev; ++alev)
     {
         // (Fine AMR correction) = I(Coarse AMR correction)
+        auto interp_start_time = amrex::second();
         interpCorrection(alev);
+        timer[interp_time] += amrex::second() - interp_start_time;
 
         MultiFab::Add(*sol[alev], *cor[alev][0], 0, 0, ncomp, nghost);
 
@@ -292,6 +339,7 @@ void
 MLMG::computeMLResidual (int amrlevmax)
 {
     BL_PROFILE("MLMG::computeMLResidual()");
+    auto res_start_time = amrex::second();
 
     const int mglev = 0;
     for (int alev = amrlevmax; alev >= 0; --alev) {
@@ -302,6 +350,8 @@ MLMG::computeMLResidual (int amrlevmax)
                          res[alev+1][mglev], *sol[alev+1], rhs[alev+1]);
         }
     }
+
+    timer[residual_time] += amrex::second() - res_start_time;
 }
 
 // Compute single AMR level residual without masking.
@@ -309,6 +359,7 @@ void
 MLMG::computeResidual (int alev)
 {
     BL_PROFILE("MLMG::computeResidual()");
+    auto res_start_time = amrex::second();
 
     MultiFab& x = *sol[alev];
     const MultiFab& b = rhs[alev];
@@ -319,6 +370,8 @@ MLMG::computeResidual (int alev)
         crse_bcdata = sol[alev-1];
     }
     linop.solutionResidual(alev, r, x, b, crse_bcdata);
+
+    timer[residual_time] += amrex::second() - res_start_time;
 }
 
 // Compute coarse AMR level composite residual with coarse solution and fine correction
@@ -326,6 +379,7 @@ void
 MLMG::computeResWithCrseSolFineCor (int calev, int falev)
 {
     BL_PROFILE("MLMG::computeResWithCrseSolFineCor()");
+    auto res_start_time = amrex::second();
 
     int ncomp = linop.getNComp();
     int nghost = 0;
@@ -360,6 +414,8 @@ MLMG::computeResWithCrseSolFineCor (int calev, int falev)
         amrex::average_down(fine_res, crse_res, 0, ncomp, amrrr);
 #endif
     }
+
+    timer[residual_time] += amrex::second() - res_start_time;
 }
 
 // Compute fine AMR level residual fine_res = fine_res - L(fine_cor) with coarse providing BC.
@@ -367,6 +423,7 @@ void
 MLMG::computeResWithCrseCorFineCor (int falev)
 {
     BL_PROFILE("MLMG::computeResWithCrseCorFineCor()");
+    auto res_start_time = amrex::second();
 
     int ncomp = linop.getNComp();
     int nghost = 0;
@@ -382,6 +439,8 @@ MLMG::computeResWithCrseCorFineCor (int falev)
     linop.correctionResidual(falev, 0, fine_rescor, fine_cor, fine_res,
                              BCMode::Inhomogeneous, &crse_cor);
     MultiFab::Copy(fine_res, fine_rescor, 0, 0, ncomp, nghost);
+
+    timer[residual_time] += amrex::second() - res_start_time;
 }
 
 void
@@ -433,12 +492,14 @@ MLMG::mgVcycle (int amrlev, int mglev_top)
         }
 
         cor[amrlev][mglev]->setVal(0.0);
+        auto smooth_start_time = amrex::second();
         bool skip_fillboundary = true;
         for (int i = 0; i < nu1; ++i) {
             linop.smooth(amrlev, mglev, *cor[amrlev][mglev], res[amrlev][mglev],
                          skip_fillboundary);
             skip_fillboundary = false;
         }
+        timer[smooth_time] += amrex::second() - smooth_start_time;
 
         // rescor = res - L(cor)
         computeResOfCorrection(amrlev, mglev);
@@ -451,7 +512,9 @@ MLMG::mgVcycle (int amrlev, int mglev_top)
         }
 
         // res_crse = R(rescor_fine); this provides res/b to the level below
+        auto restrict_start_time = amrex::second();
         linop.restriction(amrlev, mglev+1, res[amrlev][mglev+1], rescor[amrlev][mglev]);
+        timer[restrict_time] += amrex::second() - restrict_start_time;
 
     }
 
@@ -483,12 +546,14 @@ MLMG::mgVcycle (int amrlev, int mglev_top)
                            << "       Norm before smooth " << norm << "\n";
         }
         cor[amrlev][mglev_bottom]->setVal(0.0);
+        auto smooth_start_time = amrex::second();
         bool skip_fillboundary = true;
         for (int i = 0; i < nu1; ++i) {
             linop.smooth(amrlev, mglev_bottom, *cor[amrlev][mglev_bottom], res[amrlev][mglev_bottom],
                          skip_fillboundary);
             skip_fillboundary = false;
         }
+        timer[smooth_time] += amrex::second() - smooth_start_time;
         if (verbose >= 4)
         {
             computeResOfCorrection(amrlev, mglev_bottom);
@@ -504,7 +569,9 @@ MLMG::mgVcycle (int amrlev, int mglev_top)
         std::string blp_mgv_up_lev_str = make_str("MLMG::mgVcycle_up::", mglev);
         BL_PROFILE_VAR(blp_mgv_up_lev_str, blp_mgv_up_lev);
         // cor_fine += I(cor_crse)
+        auto interp_start_time = amrex::second();
         addInterpCorrection(amrlev, mglev);
+        timer[interp_time] += amrex::second() - interp_start_time;
         if (verbose >= 4)
         {
             computeResOfCorrection(amrlev, mglev);
@@ -512,9 +579,11 @@ MLMG::mgVcycle (int amrlev, int mglev_top)
             amrex::Print() << "AT LEVEL "  << amrlev << " " << mglev
                            << "   UP: Norm before smooth " << norm << "\n";
         }
+        auto smooth_start_time = amrex::second();
         for (int i = 0; i < nu2; ++i) {
             linop.smooth(amrlev, mglev, *cor[amrlev][mglev], res[amrlev][mglev]);
         }
+        timer[smooth_time] += amrex::second() - smooth_start_time;
 
         if (cf_strategy == CFStrategy::ghostnodes) computeResOfCorrection(amrlev, mglev);
 
@@ -543,6 +612,7 @@ MLMG::mgFcycle ()
     int nghost = 0;
     if (cf_strategy == CFStrategy::ghostnodes) nghost = linop.getNGrow();
 
+    auto restrict_start_time = amrex::second();
     for (int mglev = 1; mglev <= mg_bottom_lev; ++mglev)
     {
 #ifdef AMREX_USE_EB
@@ -551,13 +621,16 @@ MLMG::mgFcycle ()
         amrex::average_down(res[amrlev][mglev-1], res[amrlev][mglev], 0, ncomp, ratio);
 #endif
     }
+    timer[restrict_time] += amrex::second() - restrict_start_time;
 
     bottomSolve();
 
     for (int mglev = mg_bottom_lev-1; mglev >= 0; --mglev)
     {
         // cor_fine = I(cor_crse)
+        auto interp_start_time = amrex::second();
         interpCorrection (amrlev, mglev);
+        timer[interp_time] += amrex::second() - interp_start_time;
 
         // rescor = res - L(cor)
         computeResOfCorrection(amrlev, mglev);
@@ -866,10 +939,13 @@ void
 MLMG::computeResOfCorrection (int amrlev, int mglev)
 {
     BL_PROFILE("MLMG:computeResOfCorrection()");
+    auto res_start_time = amrex::second();
     MultiFab& x = *cor[amrlev][mglev];
     const MultiFab& b = res[amrlev][mglev];
     MultiFab& r = rescor[amrlev][mglev];
     linop.correctionResidual(amrlev, mglev, r, x, b, BCMode::Homogeneous);
+
+    timer[residual_time] += amrex::second() - res_start_time;
 }
 
 // At the true bottom of the coarset AMR level.
@@ -880,7 +956,9 @@ MLMG::bottomSolve ()
 {
     if (do_nsolve)
     {
+        auto bottom_start_time = amrex::second();
         NSolve(*ns_mlmg, *ns_sol, *ns_rhs);
+        timer[bottom_time] += amrex::second() - bottom_start_time;
     }
     else
     {
@@ -1146,11 +1224,14 @@ MLMG::prepareForSolve (const Vector<MultiFab*>& a_sol, const Vector<MultiFab con
     int nghost = 0;
     if (cf_strategy == CFStrategy::ghostnodes) nghost = linop.getNGrow();
 
+    bool linop_changed = false;
     if (!linop_prepared) {
         linop.prepareForSolve();
         linop_prepared = true;
+        linop_changed = true;
     } else if (linop.needsUpdate()) {
         linop.update();
+        linop_changed = true;
 
 #if defined(AMREX_USE_HYPRE) && (AMREX_SPACEDIM > 1)
         hypre_solver.reset();
@@ -1164,6 +1245,10 @@ MLMG::prepareForSolve (const Vector<MultiFab*>& a_sol, const Vector<MultiFab con
 #endif
     }
 
+    if (linop.getSmoother() == MLSmoother::chebyshev) {
+        linop.setupChebyshev(linop_changed);
+    }
+
     sol.resize(namrlevs);
     sol_raii.resize(namrlevs);
     for (int alev = 0; alev < namrlevs; ++alev)
@@ -0,0 +1,323 @@
+
+#include <AMReX_MLMGAutoTuner.H>
+#include <AMReX_Exception.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_Utility.H>
+
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+namespace amrex {
+
+namespace {
+
+    const char* bottom_solver_names[] = {"default", "smoother", "bicgstab", "cg",
+                                         "bicgcg", "cgbicg", "hypre", "petsc"};
+
+    BottomSolver bottom_solver_from_name (std::string const& name)
+    {
+        for (int i = 0; i < 8; ++i) {
+            if (name == bottom_solver_names[i]) {
+                return static_cast<BottomSolver>(i);
+            }
+        }
+        amrex::Abort("MLMGAutoTuner: unknown bottom solver " + name);
+        return BottomSolver::Default;
+    }
+}
+
+std::ostream&
+operator<< (std::ostream& os, MLMGAutoTuneConfig const& cfg)
+{
+    os << cfg.nu1 << " " << cfg.nu2 << " "
+       << bottom_solver_names[static_cast<int>(cfg.bottom_solver)];
+    return os;
+}
+
+MLMGAutoTuner::MLMGAutoTuner (std::string a_name, int a_max_trials,
+                              std::string a_file, Config const& a_init)
+    : m_name(std::move(a_name)),
+      m_file(std::move(a_file)),
+      m_max_trials(a_max_trials),
+      m_best(a_init),
+      m_trial(a_init)
+{
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(m_name.find_first_of(" \t\n") == std::string::npos,
+                                     "MLMGAutoTuner: name must not contain white space");
+
+    if (!m_file.empty() && readFile()) {
+        m_locked = true;
+    } else if (m_max_trials <= 1) {
+        m_locked = true;
+    }
+}
+
+void
+MLMGAutoTuner::setParams (MLMG& mlmg) const
+{
+    Config const& cfg = currentConfig();
+    mlmg.setPreSmooth(cfg.nu1);
+    mlmg.setPostSmooth(cfg.nu2);
+    mlmg.setBottomSolver(cfg.bottom_solver);
+    // The decisions use the solve time, which must agree on all processes.
+    mlmg.setCollectStats(true);
+}
+
+void
+MLMGAutoTuner::record (MLMG const& mlmg)
+{
+    if (m_locked) return;
+
+    ++m_num_trials;
+
+    // The first solve pays for one-time setup costs and is not used.
+    if (m_num_trials == 1) return;
+
+    MLMGSolveStats const& stats = mlmg.getSolveStats();
+
+    // A solve that needed no iterations tells us nothing.  The solve time
+    // and residuals are the same on all processes, so are the decisions.
+    if (stats.num_iters > 0)
+    {
+        Real cost = std::numeric_limits<Real>::max();
+        if (stats.converged && stats.final_residual > 0.0 &&
+            stats.final_residual < stats.init_residual)
+        {
+            Real digits = std::log10(stats.init_residual/stats.final_residual);
+            cost = static_cast<Real>(stats.solve_time) / digits;
+        }
+
+        update(cost, stats.num_iters);
+    }
+
+    if (m_param >= nparams || m_num_trials >= m_max_trials) {
+        lockIn();
+    }
+}
+
+void
+MLMGAutoTuner::recordFailure ()
+{
+    if (m_locked) return;
+
+    ++m_num_trials;
+    ++m_num_failed;
+
+    if (m_num_trials > 1) {
+        update(std::numeric_limits<Real>::max(), -1);
+    }
+
+    if (m_param >= nparams || m_num_trials >= m_max_trials) {
+        lockIn();
+    }
+}
+
+void
+MLMGAutoTuner::update (Real cost, int num_iters)
+{
+    if (m_verbose > 0) {
+        amrex::Print() << "MLMGAutoTuner " << m_name << ": trial " << m_trial;
+        if (num_iters < 0) {
+            amrex::Print() << ", failed to converge\n";
+        } else {
+            amrex::Print() << ", iterations = " << num_iters
+                           << ", seconds per digit = " << cost << "\n";
+        }
+    }
+
+    if (m_param < 0 || cost < m_best_cost) {
+        m_best = m_trial;
+        m_best_cost = cost;
+    }
+
+    nextTrial();
+}
+
+Real
+MLMGAutoTuner::solve (MLMG& mlmg, const Vector<MultiFab*>& a_sol,
+                      const Vector<MultiFab const*>& a_rhs, Real a_tol_rel, Real a_tol_abs)
+{
+    setParams(mlmg);
+
+    if (m_locked) {
+        return mlmg.solve(a_sol, a_rhs, a_tol_rel, a_tol_abs);
+    }
+
+    // Keep the initial guess so that a failed trial can be redone.
+    Vector<MultiFab> sol0(a_sol.size());
+    for (int lev = 0; lev < static_cast<int>(a_sol.size()); ++lev) {
+        MultiFab const& sol = *a_sol[lev];
+        sol0[lev].define(sol.boxArray(), sol.DistributionMap(), sol.nComp(), sol.nGrowVect(),
+                         MFInfo(), sol.Factory());
+        MultiFab::Copy(sol0[lev], sol, 0, 0, sol.nComp(), sol.nGrowVect());
+    }
+
+    Real r;
+    mlmg.setThrowException(true);
+    try {
+        r = mlmg.solve(a_sol, a_rhs, a_tol_rel, a_tol_abs);
+    } catch (RuntimeError const&) {
+        // The failure is detected from reduced norms, so all processes get here.
+        mlmg.setThrowException(false);
+        recordFailure();
+
+        for (int lev = 0; lev < static_cast<int>(a_sol.size()); ++lev) {
+            MultiFab::Copy(*a_sol[lev], sol0[lev], 0, 0, sol0[lev].nComp(), sol0[lev].nGrowVect());
+        }
+        mlmg.setPreSmooth(m_best.nu1);
+        mlmg.setPostSmooth(m_best.nu2);
+        mlmg.setBottomSolver(m_best.bottom_solver);
+        return mlmg.solve(a_sol, a_rhs, a_tol_rel, a_tol_abs);
+    }
+    mlmg.setThrowException(false);
+
+    record(mlmg);
+    return r;
+}
+
+Vector<int>
+MLMGAutoTuner::candidates (int param)
+{
+    switch (param) {
+    case nu1_param:
+    case nu2_param:
+        return {1, 2, 3, 4};
+    case bottom_param:
+        return {static_cast<int>(BottomSolver::bicgstab),
+                static_cast<int>(BottomSolver::cg),
+                static_cast<int>(BottomSolver::smoother)
+#if defined(AMREX_USE_HYPRE) && (AMREX_SPACEDIM > 1)
+               ,static_cast<int>(BottomSolver::hypre)
+#endif
+        };
+    default:
+        return {};
+    }
+}
+
+void
+MLMGAutoTuner::setParam (Config& cfg, int param, int value) noexcept
+{
+    switch (param) {
+    case nu1_param:    cfg.nu1 = value; break;
+    case nu2_param:    cfg.nu2 = value; break;
+    case bottom_param: cfg.bottom_solver = static_cast<BottomSolver>(value); break;
+    default: break;
+    }
+}
+
+int
+MLMGAutoTuner::getParam (Config const& cfg, int param) noexcept
+{
+    switch (param) {
+    case nu1_param:    return cfg.nu1;
+    case nu2_param:    return cfg.nu2;
+    case bottom_param: return static_cast<int>(cfg.bottom_solver);
+    default:           return -1;
+    }
+}
+
+void
+MLMGAutoTuner::nextTrial ()
+{
+    // Move to the next candidate that differs from the best configuration.
+    // The parameters are searched one after another.
+    if (m_param < 0) {
+        m_param = 0;
+        m_cand = 0;
+    } else {
+        ++m_cand;
+    }
+
+    for (; m_param < nparams; ++m_param, m_cand = 0)
+    {
+        Vector<int> const cands = candidates(m_param);
+        for (; m_cand < static_cast<int>(cands.size()); ++m_cand)
+        {
+            if (cands[m_cand] != getParam(m_best, m_param)) {
+                m_trial = m_best;
+                setParam(m_trial, m_param, cands[m_cand]);
+                return;
+            }
+        }
+    }
+}
+
+void
+MLMGAutoTuner::lockIn ()
+{
+    m_locked = true;
+
+    if (m_verbose > 0) {
+        amrex::Print() << "MLMGAutoTuner " << m_name << ": using " << m_best
+                       << ", seconds per digit = " << m_best_cost << "\n";
+    }
+
+    if (!m_file.empty()) {
+        writeFile();
+    }
+}
+
+bool
+MLMGAutoTuner::readFile ()
+{
+    int exist = 0;
+    if (ParallelDescriptor::IOProcessor()) {
+        exist = amrex::FileExists(m_file);
+    }
+    ParallelDescriptor::Bcast(&exist, 1, ParallelDescriptor::IOProcessorNumber());
+    if (!exist) return false;
+
+    Vector<char> buf;
+    ParallelDescriptor::ReadAndBcastFile(m_file, buf);
+    std::istringstream is(buf.dataPtr());
+
+    std::string line;
+    while (std::getline(is, line))
+    {
+        std::istringstream ls(line);
+        std::string name, bottom;
+        Config cfg;
+        if (ls >> name >> cfg.nu1 >> cfg.nu2 >> bottom && name == m_name)
+        {
+            cfg.bottom_solver = bottom_solver_from_name(bottom);
+            ls >> m_best_cost;
+            m_best = cfg;
+            return true;
+        }
+    }
+    return false;
+}
+
+void
+MLMGAutoTuner::writeFile () const
+{
+    if (!ParallelDescriptor::IOProcessor()) return;
+
+    // Keep the entries of other tuners.
+    Vector<std::string> lines;
+    {
+        std::ifstream ifs(m_file);
+        std::string line;
+        while (std::getline(ifs, line)) {
+            std::istringstream ls(line);
+            std::string name;
+            if (ls >> name && name != m_name) {
+                lines.push_back(line);
+            }
+        }
+    }
+
+    std::ofstream ofs(m_file, std::ios::trunc);
+    if (!ofs.good()) {
+        amrex::FileOpenFailed(m_file);
+    }
+    for (auto const& line : lines) {
+        ofs << line << "\n";
+    }
+    ofs.precision(6);
+    ofs << m_name << " " << m_best << " " << m_best_cost << "\n";
+}
+
+}
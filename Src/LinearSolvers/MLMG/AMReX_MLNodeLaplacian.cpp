@@ -1949,6 +1949,43 @@ MLNodeLaplacian::normalize (int amrlev, int mglev, MultiFab& mf) const
     }
 }
 
+void
+MLNodeLaplacian::compInvDiag (int amrlev, int mglev, MultiFab& invdiag) const
+{
+    if (m_sigma[0][0][0] != nullptr) {
+        MLNodeLinOp::compInvDiag(amrlev, mglev, invdiag);
+        return;
+    }
+
+    // normalize does nothing for constant sigma.  This is the diagonal
+    // used by mlndlap_jacobi_c.
+    const auto dxinv = m_geom[amrlev][mglev].InvCellSizeArray();
+#if (AMREX_SPACEDIM == 1)
+    const Real diag = Real(-2.0)*m_const_sigma*dxinv[0]*dxinv[0];
+#elif (AMREX_SPACEDIM == 2)
+    const Real diag = Real(-4.0/3.0)*m_const_sigma*(dxinv[0]*dxinv[0] + dxinv[1]*dxinv[1]);
+#else
+    const Real diag = Real(-8.0/9.0)*m_const_sigma*(dxinv[0]*dxinv[0] + dxinv[1]*dxinv[1]
+                                                    + dxinv[2]*dxinv[2]);
+#endif
+    const Real dinv = Real(1.0)/diag;
+    const iMultiFab& dmsk = *m_dirichlet_mask[amrlev][mglev];
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(invdiag,TilingIfNotGPU()); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.tilebox();
+        Array4<Real> const& da = invdiag.array(mfi);
+        Array4<int const> const& dmskarr = dmsk.const_array(mfi);
+        amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+        {
+            da(i,j,k) = dmskarr(i,j,k) ? Real(0.0) : dinv;
+        });
+    }
+}
+
 void
 MLNodeLaplacian::compSyncResidualCoarse (MultiFab& sync_resid, const MultiFab& a_phi,
                                          const MultiFab& vold, const MultiFab* rhcc,
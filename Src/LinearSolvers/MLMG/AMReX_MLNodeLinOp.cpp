@@ -131,12 +131,39 @@ void
 MLNodeLinOp::smooth (int amrlev, int mglev, MultiFab& sol, const MultiFab& rhs,
                      bool skip_fillboundary) const
 {
+    if (m_smoother == MLSmoother::chebyshev) {
+        chebyshevSmooth(amrlev, mglev, sol, rhs);
+        return;
+    }
     if (!skip_fillboundary) {
         applyBC(amrlev, mglev, sol, BCMode::Homogeneous, StateMode::Solution);
     }
     Fsmooth(amrlev, mglev, sol, rhs);
 }
 
+void
+MLNodeLinOp::compInvDiag (int amrlev, int mglev, MultiFab& invdiag) const
+{
+    MLLinOp::compInvDiag(amrlev, mglev, invdiag);
+
+    // Dirichlet nodes are not relaxed.
+    const iMultiFab& dmsk = *m_dirichlet_mask[amrlev][mglev];
+    const int ncomp = invdiag.nComp();
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(invdiag,TilingIfNotGPU()); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.tilebox();
+        Array4<Real> const& da = invdiag.array(mfi);
+        Array4<int const> const& dmskarr = dmsk.const_array(mfi);
+        amrex::ParallelFor(bx, ncomp, [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
+        {
+            if (dmskarr(i,j,k)) da(i,j,k,n) = 0.0;
+        });
+    }
+}
+
 Real
 MLNodeLinOp::xdoty (int amrlev, int mglev, const MultiFab& x, const MultiFab& y, bool local) const
 {
@@ -1,4 +1,5 @@
 #include <AMReX_ParticleCommunication.H>
+#include <AMReX_ParticleMPIUtil.H>
 #include <AMReX_ParallelDescriptor.H>
 
 using namespace amrex;
@@ -269,7 +270,16 @@ void ParticleCopyPlan::doHandShake (const Vector<Long>& Snds, Vector<Long>& Rcvs
 {
     BL_PROFILE("ParticleCopyPlan::doHandShake");
     if (m_local) doHandShakeLocal(Snds, Rcvs);
-    else doHandShakeGlobal(Snds, Rcvs);
+    else doHandShakeNBX(Snds, Rcvs);
+}
+
+void ParticleCopyPlan::doHandShakeNBX (const Vector<Long>& Snds, Vector<Long>& Rcvs) const
+{
+#ifdef AMREX_USE_MPI
+    amrex::doHandShakeNBX(Snds, Rcvs);
+#else
+    amrex::ignore_unused(Snds,Rcvs);
+#endif
 }
 
 void ParticleCopyPlan::doHandShakeLocal (const Vector<Long>& Snds, Vector<Long>& Rcvs) const
@@ -313,73 +323,6 @@ void ParticleCopyPlan::doHandShakeLocal (const Vector<Long>& Snds, Vector<Long>&
 #endif
 }
 
-void ParticleCopyPlan::doHandShakeAllToAll (const Vector<Long>& Snds, Vector<Long>& Rcvs) const
-{
-#ifdef AMREX_USE_MPI
-    BL_COMM_PROFILE(BLProfiler::Alltoall, sizeof(Long),
-                    ParallelContext::MyProcSub(), BLProfiler::BeforeCall());
-
-    BL_MPI_REQUIRE( MPI_Alltoall(Snds.dataPtr(),
-                                 1,
-                                 ParallelDescriptor::Mpi_typemap<Long>::type(),
-                                 Rcvs.dataPtr(),
-                                 1,
-                                 ParallelDescriptor::Mpi_typemap<Long>::type(),
-                                 ParallelContext::CommunicatorSub()) );
-
-    AMREX_ASSERT(Rcvs[ParallelContext::MyProcSub()] == 0);
-
-    BL_COMM_PROFILE(BLProfiler::Alltoall, sizeof(Long),
-                    ParallelContext::MyProcSub(), BLProfiler::AfterCall());
-#else
-    amrex::ignore_unused(Snds,Rcvs);
-#endif
-}
-
-void ParticleCopyPlan::doHandShakeGlobal (const Vector<Long>& Snds, Vector<Long>& Rcvs) const
-{
-#ifdef AMREX_USE_MPI
-    const int SeqNum = ParallelDescriptor::SeqNum();
-    const int NProcs = ParallelContext::NProcsSub();
-
-    Vector<Long> snd_connectivity(NProcs, 0);
-    Vector<int > rcv_connectivity(NProcs, 1);
-    for (int i = 0; i < NProcs; ++i) { if (Snds[i] > 0) snd_connectivity[i] = 1; }
-
-    Long num_rcvs = 0;
-    MPI_Reduce_scatter(snd_connectivity.data(), &num_rcvs, rcv_connectivity.data(),
-                       ParallelDescriptor::Mpi_typemap<Long>::type(), MPI_SUM,
-                       ParallelContext::CommunicatorSub());
-
-    Vector<MPI_Status>  stats(num_rcvs);
-    Vector<MPI_Request> rreqs(num_rcvs);
-
-    Vector<Long> num_bytes_rcv(num_rcvs);
-    for (int i = 0; i < num_rcvs; ++i)
-    {
-        MPI_Irecv( &num_bytes_rcv[i], 1, ParallelDescriptor::Mpi_typemap<Long>::type(),
-                   MPI_ANY_SOURCE, SeqNum, ParallelContext::CommunicatorSub(), &rreqs[i] );
-    }
-    for (int i = 0; i < NProcs; ++i)
-    {
-        if (Snds[i] == 0) continue;
-        const Long Cnt = 1;
-        MPI_Send( &Snds[i], Cnt, ParallelDescriptor::Mpi_typemap<Long>::type(), i, SeqNum,
-                  ParallelContext::CommunicatorSub());
-    }
-
-    MPI_Waitall(num_rcvs, rreqs.data(), stats.data());
-
-    for (int i = 0; i < num_rcvs; ++i)
-    {
-        const auto Who = stats[i].MPI_SOURCE;
-        Rcvs[Who] = num_bytes_rcv[i];
-    }
-#else
-    amrex::ignore_unused(Snds,Rcvs);
-#endif
-}
-
 void amrex::communicateParticlesFinish (const ParticleCopyPlan& plan)
 {
     BL_PROFILE("amrex::communicateParticlesFinish");
@@ -8,45 +8,6 @@ namespace amrex {
 
 #ifdef AMREX_USE_MPI
 
-    Long CountSnds(const std::map<int, Vector<char> >& not_ours, Vector<Long>& Snds)
-    {
-        Long NumSnds = 0;
-        for (const auto& kv : not_ours)
-        {
-            NumSnds       += kv.second.size();
-            Snds[kv.first] = kv.second.size();
-        }
-
-        ParallelAllReduce::Max(NumSnds, ParallelContext::CommunicatorSub());
-
-        return NumSnds;
-    }
-
-    Long doHandShake(const std::map<int, Vector<char> >& not_ours,
-                     Vector<Long>& Snds, Vector<Long>& Rcvs)
-    {
-        Long NumSnds = CountSnds(not_ours, Snds);
-        if (NumSnds == 0) return NumSnds;
-
-        BL_COMM_PROFILE(BLProfiler::Alltoall, sizeof(Long),
-                        ParallelContext::MyProcSub(), BLProfiler::BeforeCall());
-
-        BL_MPI_REQUIRE( MPI_Alltoall(Snds.dataPtr(),
-                                     1,
-                                     ParallelDescriptor::Mpi_typemap<Long>::type(),
-                                     Rcvs.dataPtr(),
-                                     1,
-                                     ParallelDescriptor::Mpi_typemap<Long>::type(),
-                                     ParallelContext::CommunicatorSub()) );
-
-        AMREX_ASSERT(Rcvs[ParallelContext::MyProcSub()] == 0);
-
-        BL_COMM_PROFILE(BLProfiler::Alltoall, sizeof(Long),
-                        ParallelContext::MyProcSub(), BLProfiler::AfterCall());
-
-        return NumSnds;
-    }
-
     Long doHandShakeLocal(const std::map<int, Vector<char> >& not_ours,
                           const Vector<int>& neighbor_procs, Vector<Long>& Snds, Vector<Long>& Rcvs)
     {
@@ -92,6 +53,74 @@ namespace amrex {
 
         return NumSnds;
     }
+
+    void doHandShakeNBX(const Vector<Long>& Snds, Vector<Long>& Rcvs)
+    {
+        BL_PROFILE("doHandShakeNBX()");
+
+        const int SeqNum = ParallelDescriptor::SeqNum();
+        const int NProcs = ParallelContext::NProcsSub();
+        MPI_Comm comm = ParallelContext::CommunicatorSub();
+        const auto mpi_long = ParallelDescriptor::Mpi_typemap<Long>::type();
+
+        // Synchronous sends complete only once they have been matched,
+        // so when all of ours are done every message we sent has arrived.
+        Vector<MPI_Request> sreqs;
+        for (int i = 0; i < NProcs; ++i) {
+            if (Snds[i] == 0) continue;
+            MPI_Request req;
+            BL_MPI_REQUIRE( MPI_Issend(&Snds[i], 1, mpi_long, i, SeqNum, comm, &req) );
+            sreqs.push_back(req);
+        }
+
+        MPI_Request barrier_req = MPI_REQUEST_NULL;
+        bool barrier_started = false;
+        while (true)
+        {
+            int has_msg = 0;
+            MPI_Status status;
+            BL_MPI_REQUIRE( MPI_Iprobe(MPI_ANY_SOURCE, SeqNum, comm, &has_msg, &status) );
+            if (has_msg) {
+                const int Who = status.MPI_SOURCE;
+                BL_MPI_REQUIRE( MPI_Recv(&Rcvs[Who], 1, mpi_long, Who, SeqNum, comm,
+                                         MPI_STATUS_IGNORE) );
+                continue;
+            }
+
+            if (barrier_started) {
+                int done = 0;
+                BL_MPI_REQUIRE( MPI_Test(&barrier_req, &done, MPI_STATUS_IGNORE) );
+                if (done) break;
+            } else {
+                int sent = 0;
+                BL_MPI_REQUIRE( MPI_Testall(sreqs.size(), sreqs.data(), &sent,
+                                            MPI_STATUSES_IGNORE) );
+                if (sent) {
+                    // Everyone who has finished sending enters the barrier.
+                    // Once it completes, no more messages are on the way.
+                    BL_MPI_REQUIRE( MPI_Ibarrier(comm, &barrier_req) );
+                    barrier_started = true;
+                }
+            }
+        }
+
+        AMREX_ASSERT(Rcvs[ParallelContext::MyProcSub()] == 0);
+    }
+
+    Long doHandShakeNBX(const std::map<int, Vector<char> >& not_ours,
+                        Vector<Long>& Snds, Vector<Long>& Rcvs)
+    {
+        Long NumSnds = 0;
+        for (const auto& kv : not_ours)
+        {
+            NumSnds       += kv.second.size();
+            Snds[kv.first] = kv.second.size();
+        }
+
+        doHandShakeNBX(Snds, Rcvs);
+
+        return NumSnds;
+    }
 #endif  // AMREX_USE_MPI
 
 }
@@ -0,0 +1,352 @@
+//
+// Run a small two-level AmrLevel problem whose state only changes in the
+// grids that touch the low x side of the domain, so that most fabs of a
+// delta checkpoint come from its base.  The final state of every level is
+// written to test.final_L<level> and, with test.compare, compared with
+// the one another run wrote.  With test.compare_checkpoint, the state read
+// at restart is compared with that checkpoint.  test.rewrite names a file
+// to append a line to before the run starts, to rewrite the base of a
+// delta checkpoint.  With test.half_drain, the restart checkpoint is first
+// put back into amr.checkpoint_stage_dir and half copied out, as if the run
+// that wrote it had stopped while draining it.  A run with a staging
+// directory must leave it empty.
+//
+
+#include <AMReX.H>
+#include <AMReX_Amr.H>
+#include <AMReX_AmrLevel.H>
+#include <AMReX_FileSystem.H>
+#include <AMReX_LevelBld.H>
+#include <AMReX_PROB_AMR_F.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+#include <AMReX_VisMF.H>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace amrex;
+
+extern "C" {
+    void amrex_probinit (const int* /*init*/,
+                         const int* /*name*/,
+                         const int* /*namelen*/,
+                         const amrex_real* /*problo*/,
+                         const amrex_real* /*probhi*/)
+    {
+    }
+}
+
+namespace {
+
+const Real dt_coarse = 0.1;
+
+void nullfill (Box const& /*bx*/, FArrayBox& /*data*/,
+               const int /*dcomp*/, const int /*numcomp*/,
+               Geometry const& /*geom*/, const Real /*time*/,
+               const Vector<BCRec>& /*bcr*/, const int /*bcomp*/,
+               const int /*scomp*/)
+{
+}
+
+// ---- number of cells where a and b differ, b may have another DistributionMapping
+Long num_different (MultiFab const& a, MultiFab const& b)
+{
+    AMREX_ALWAYS_ASSERT(a.boxArray() == b.boxArray() && a.nComp() == b.nComp());
+    MultiFab bb(a.boxArray(), a.DistributionMap(), a.nComp(), 0);
+    bb.ParallelCopy(b, 0, 0, a.nComp());
+    Long ndiff = 0;
+    for (MFIter mfi(a); mfi.isValid(); ++mfi) {
+        auto const& aa = a.const_array(mfi);
+        auto const& ba = bb.const_array(mfi);
+        amrex::LoopOnCpu(mfi.validbox(), a.nComp(), [&] (int i, int j, int k, int n) noexcept
+        {
+            if (aa(i,j,k,n) != ba(i,j,k,n)) ++ndiff;
+        });
+    }
+    ParallelDescriptor::ReduceLongSum(ndiff);
+    return ndiff;
+}
+
+void compare (MultiFab const& mf, const std::string& ref_name)
+{
+    MultiFab ref;
+    VisMF::Read(ref, ref_name);
+    const Long ndiff = num_different(mf, ref);
+    if (ndiff != 0) {
+        amrex::Abort("Checkpoint test: " + std::to_string(ndiff) +
+                     " cells differ from " + ref_name);
+    }
+    amrex::Print() << "Checkpoint test: matches " << ref_name << "\n";
+}
+
+void copy_file (const std::string& src, const std::string& dst)
+{
+    const std::string dstdir = dst.substr(0, dst.rfind('/'));
+    if ( ! FileSystem::CreateDirectories(dstdir, 0755)) {
+        amrex::CreateDirectoryFailed(dstdir);
+    }
+    std::ifstream ifs(src, std::ios::in | std::ios::binary);
+    std::ofstream ofs(dst, std::ios::out | std::ios::trunc | std::ios::binary);
+    ofs << ifs.rdbuf();
+    if ( ! ifs.good() || ! ofs.good()) {
+        amrex::Abort("Checkpoint test: failed to copy " + src + " to " + dst);
+    }
+}
+
+//
+// Leave ckfile as a run that stopped while draining it from stage_dir
+// would: the staged copy is complete, ckfile.temp has every other file
+// and ckfile is missing.
+//
+void half_drain (const std::string& ckfile, const std::string& stage_dir)
+{
+    if (ParallelDescriptor::IOProcessor()) {
+        const std::vector<std::string> files = FileSystem::ListFiles(ckfile);
+        AMREX_ALWAYS_ASSERT( ! files.empty());
+        for (int i = 0; i < static_cast<int>(files.size()); ++i) {
+            copy_file(ckfile + "/" + files[i], stage_dir + "/" + ckfile + "/" + files[i]);
+            if (i % 2 == 0) {
+                copy_file(ckfile + "/" + files[i], ckfile + ".temp/" + files[i]);
+            }
+        }
+        FileSystem::RemoveAll(ckfile);
+    }
+    ParallelDescriptor::Barrier();
+}
+
+}
+
+class CheckpointLevel
+    :
+    public AmrLevel
+{
+public:
+    CheckpointLevel () = default;
+
+    CheckpointLevel (Amr& papa, int lev, const Geometry& level_geom,
+                     const BoxArray& ba, const DistributionMapping& dm, Real time)
+        : AmrLevel(papa, lev, level_geom, ba, dm, time) {}
+
+    static void variableSetUp ()
+    {
+        desc_lst.addDescriptor(0, IndexType::TheCellType(), StateDescriptor::Point,
+                               0, 1, &cell_cons_interp);
+        int lo_bc[AMREX_SPACEDIM];
+        int hi_bc[AMREX_SPACEDIM];
+        for (int i = 0; i < AMREX_SPACEDIM; ++i) {
+            lo_bc[i] = hi_bc[i] = BCType::int_dir;   // periodic boundaries
+        }
+        desc_lst.setComponent(0, 0, "phi", BCRec(lo_bc, hi_bc),
+                              StateDescriptor::BndryFunc(nullfill));
+    }
+
+    static void variableCleanUp () { desc_lst.clear(); }
+
+    virtual void initData () override
+    {
+        MultiFab& S_new = get_new_data(0);
+        const int lev = level;
+        for (MFIter mfi(S_new); mfi.isValid(); ++mfi) {
+            auto const& s = S_new.array(mfi);
+            amrex::LoopOnCpu(mfi.validbox(), [&] (int i, int j, int k) noexcept
+            {
+                s(i,j,k) = Real(1.0) + i + Real(0.1)*j + Real(0.01)*k + Real(100.)*lev;
+            });
+        }
+    }
+
+    virtual void init (AmrLevel& old) override
+    {
+        const Real cur_time  = old.get_state_data(0).curTime();
+        const Real prev_time = old.get_state_data(0).prevTime();
+        setTimeLevel(cur_time, cur_time - prev_time, parent->dtLevel(level));
+        FillPatch(old, get_new_data(0), 0, cur_time, 0, 0, 1);
+    }
+
+    virtual void init () override
+    {
+        const Real cur_time  = parent->getLevel(level-1).get_state_data(0).curTime();
+        const Real prev_time = parent->getLevel(level-1).get_state_data(0).prevTime();
+        const Real dt_old = (cur_time - prev_time)/Real(parent->MaxRefRatio(level-1));
+        setTimeLevel(cur_time, dt_old, parent->dtLevel(level));
+        FillCoarsePatch(get_new_data(0), 0, cur_time, 0, 0, 1);
+    }
+
+    virtual Real advance (Real /*time*/, Real dt, int /*iteration*/, int /*ncycle*/) override
+    {
+        for (int k = 0; k < desc_lst.size(); ++k) {
+            state[k].allocOldData();
+            state[k].swapTimeLevels(dt);
+        }
+        MultiFab& S_new = get_new_data(0);
+        const MultiFab& S_old = get_old_data(0);
+        const int xlo = geom.Domain().smallEnd(0);
+        for (MFIter mfi(S_new); mfi.isValid(); ++mfi) {
+            const Box& bx = mfi.validbox();
+            auto const& s = S_new.array(mfi);
+            auto const& so = S_old.const_array(mfi);
+            const Real ds = (bx.smallEnd(0) == xlo) ? dt : Real(0.0);
+            amrex::LoopOnCpu(bx, [&] (int i, int j, int k) noexcept
+            {
+                s(i,j,k) = so(i,j,k) + ds*(i+1);
+            });
+        }
+        return dt;
+    }
+
+    virtual void computeInitialDt (int finest_level, int /*sub_cycle*/,
+                                   Vector<int>& n_cycle,
+                                   const Vector<IntVect>& /*ref_ratio*/,
+                                   Vector<Real>& dt_level, Real /*stop_time*/) override
+    {
+        computeDt(finest_level, n_cycle, dt_level);
+    }
+
+    virtual void computeNewDt (int finest_level, int /*sub_cycle*/,
+                               Vector<int>& n_cycle,
+                               const Vector<IntVect>& /*ref_ratio*/,
+                               Vector<Real>& /*dt_min*/, Vector<Real>& dt_level,
+                               Real /*stop_time*/, int /*post_regrid_flag*/) override
+    {
+        computeDt(finest_level, n_cycle, dt_level);
+    }
+
+    virtual void post_timestep (int /*iteration*/) override {}
+
+    virtual void post_regrid (int /*lbase*/, int /*new_finest*/) override {}
+
+    virtual void post_init (Real /*stop_time*/) override {}
+
+    //
+    // Refine the middle half of the domain.
+    //
+    virtual void errorEst (TagBoxArray& tags, int /*clearval*/, int tagval,
+                           Real /*time*/, int /*n_error_buf*/, int /*ngrow*/) override
+    {
+        Box region = geom.Domain();
+        region.grow(-geom.Domain().length(0)/4);
+        for (MFIter mfi(tags); mfi.isValid(); ++mfi) {
+            const Box bx = mfi.validbox() & region;
+            if (bx.ok()) {
+                tags[mfi].setVal<RunOn::Host>(static_cast<TagBox::TagType>(tagval), bx);
+            }
+        }
+    }
+
+private:
+
+    void computeDt (int finest_level, const Vector<int>& n_cycle, Vector<Real>& dt_level)
+    {
+        if (level > 0) return;
+        dt_level[0] = dt_coarse;
+        for (int lev = 1; lev <= finest_level; ++lev) {
+            dt_level[lev] = dt_level[lev-1]/n_cycle[lev];
+        }
+    }
+};
+
+class CheckpointLevelBld
+    :
+    public LevelBld
+{
+    virtual void variableSetUp () override { CheckpointLevel::variableSetUp(); }
+    virtual void variableCleanUp () override { CheckpointLevel::variableCleanUp(); }
+    virtual AmrLevel *operator() () override { return new CheckpointLevel; }
+    virtual AmrLevel *operator() (Amr& papa, int lev, const Geometry& level_geom,
+                                  const BoxArray& ba, const DistributionMapping& dm,
+                                  Real time) override
+    {
+        return new CheckpointLevel(papa, lev, level_geom, ba, dm, time);
+    }
+};
+
+CheckpointLevelBld checkpoint_level_bld;
+
+LevelBld*
+getLevelBld ()
+{
+    return &checkpoint_level_bld;
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int max_step = 0;
+        std::string final_name, compare_name, compare_checkpoint, rewrite;
+        std::string restart_file, stage_dir;
+        bool do_half_drain = false;
+        {
+            ParmParse pp;
+            pp.query("max_step", max_step);
+        }
+        {
+            ParmParse pp("amr");
+            pp.query("restart", restart_file);
+            pp.query("checkpoint_stage_dir", stage_dir);
+        }
+        {
+            ParmParse pp("test");
+            pp.get("final", final_name);
+            pp.query("compare", compare_name);
+            pp.query("compare_checkpoint", compare_checkpoint);
+            pp.query("rewrite", rewrite);
+            pp.query("half_drain", do_half_drain);
+        }
+
+        if ( ! rewrite.empty()) {
+            if (ParallelDescriptor::IOProcessor()) {
+                std::ofstream ofs(rewrite, std::ios::out | std::ios::app);
+                ofs << '\n';
+                if ( ! ofs.good()) {
+                    amrex::FileOpenFailed(rewrite);
+                }
+            }
+            ParallelDescriptor::Barrier();
+        }
+
+        if (do_half_drain) {
+            AMREX_ALWAYS_ASSERT( ! restart_file.empty() && ! stage_dir.empty());
+            half_drain(restart_file, stage_dir);
+        }
+
+        {
+            Amr amr;
+            amr.init(0.0, -1.0);
+
+            if ( ! compare_checkpoint.empty()) {
+                for (int lev = 0; lev <= amr.finestLevel(); ++lev) {
+                    const std::string dir = compare_checkpoint + "/Level_" + std::to_string(lev);
+                    compare(amr.getLevel(lev).get_new_data(0), dir + "/SD_0_New_MF");
+                    if (amr.getLevel(lev).get_state_data(0).hasOldData()) {
+                        compare(amr.getLevel(lev).get_old_data(0), dir + "/SD_0_Old_MF");
+                    }
+                }
+            }
+
+            while (amr.okToContinue() && amr.levelSteps(0) < max_step) {
+                amr.coarseTimeStep(-1.0);
+            }
+
+            for (int lev = 0; lev <= amr.finestLevel(); ++lev) {
+                const std::string suffix = "_L" + std::to_string(lev);
+                VisMF::Write(amr.getLevel(lev).get_new_data(0), final_name + suffix);
+                if ( ! compare_name.empty()) {
+                    compare(amr.getLevel(lev).get_new_data(0), compare_name + suffix);
+                }
+            }
+        }
+
+        // ---- every staged checkpoint has been moved into place
+        if ( ! stage_dir.empty() && ParallelDescriptor::IOProcessor()) {
+            const std::vector<std::string> left = FileSystem::ListFiles(stage_dir);
+            if ( ! left.empty()) {
+                amrex::Abort("Checkpoint test: " + stage_dir + "/" + left[0] + " is left");
+            }
+            amrex::Print() << "Checkpoint test: " << stage_dir << " is empty\n";
+        }
+    }
+    amrex::Finalize();
+}
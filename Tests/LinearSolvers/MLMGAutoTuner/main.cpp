@@ -0,0 +1,97 @@
+//
+// Tune a recurring Poisson solve whose iteration limit is so tight that
+// some of the candidate configurations fail to converge.  The failed
+// trials must be skipped and every solve must still return a solution.
+//
+
+#include <AMReX.H>
+#include <AMReX_MLMG.H>
+#include <AMReX_MLMGAutoTuner.H>
+#include <AMReX_MLPoisson.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+
+#include <cmath>
+
+using namespace amrex;
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int n_cell = 64;
+        int max_grid_size = 32;
+        int max_iter = 9;
+        int num_solves = 12;
+        int verbose = 1;
+        Real tol_rel = 1.e-10;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("max_iter", max_iter);
+            pp.query("num_solves", num_solves);
+            pp.query("verbose", verbose);
+            pp.query("tol_rel", tol_rel);
+        }
+
+        Box domain(IntVect(0), IntVect(n_cell-1));
+        RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+        Geometry geom(domain, rb, CoordSys::cartesian, {AMREX_D_DECL(0,0,0)});
+        BoxArray grids(domain);
+        grids.maxSize(max_grid_size);
+        DistributionMapping dmap(grids);
+
+        MultiFab sol(grids, dmap, 1, 1);
+        MultiFab rhs(grids, dmap, 1, 0);
+
+        auto const dx = geom.CellSizeArray();
+        for (MFIter mfi(rhs); mfi.isValid(); ++mfi) {
+            Box const& bx = mfi.validbox();
+            auto const& a = rhs.array(mfi);
+            amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+            {
+                AMREX_D_TERM(Real x = (i+Real(0.5))*dx[0];,
+                             Real y = (j+Real(0.5))*dx[1];,
+                             Real z = (k+Real(0.5))*dx[2];)
+                a(i,j,k) = AMREX_D_TERM(std::sin(Real(3.)*x),
+                                       *std::sin(Real(5.)*y),
+                                       *std::sin(Real(7.)*z));
+            });
+        }
+
+        MLMGAutoTuner tuner("poisson", num_solves);
+        tuner.setVerbose(verbose);
+
+        MLPoisson linop({geom}, {grids}, {dmap});
+        linop.setDomainBC({AMREX_D_DECL(LinOpBCType::Dirichlet,
+                                        LinOpBCType::Dirichlet,
+                                        LinOpBCType::Dirichlet)},
+                          {AMREX_D_DECL(LinOpBCType::Dirichlet,
+                                        LinOpBCType::Dirichlet,
+                                        LinOpBCType::Dirichlet)});
+        linop.setLevelBC(0, nullptr);
+
+        MLMG mlmg(linop);
+        mlmg.setMaxIter(max_iter);
+        mlmg.setVerbose(0);
+
+        for (int isolve = 0; isolve < num_solves; ++isolve) {
+            sol.setVal(0.0);
+            tuner.solve(mlmg, {&sol}, {&rhs}, tol_rel, 0.0);
+
+            MLMGSolveStats const& stats = mlmg.getSolveStats();
+            AMREX_ALWAYS_ASSERT(stats.converged);
+        }
+
+        if (verbose > 0) {
+            amrex::Print() << "Failed trials: " << tuner.numFailedTrials()
+                           << ", best configuration: " << tuner.bestConfig() << "\n";
+        }
+
+        AMREX_ALWAYS_ASSERT(tuner.isLocked());
+        AMREX_ALWAYS_ASSERT(tuner.numFailedTrials() > 0);
+    }
+    amrex::Finalize();
+}
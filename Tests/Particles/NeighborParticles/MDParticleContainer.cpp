@@ -431,6 +431,112 @@ void MDParticleContainer::checkNeighborList()
     amrex::PrintToFile("neighbor_test") << "All the neighbor list particles match!" << std::endl;
 }
 
+void MDParticleContainer::checkHalfNeighborList()
+{
+    BL_PROFILE("MDParticleContainer::checkHalfNeighborList");
+
+    const int lev = 0;
+    auto& plev  = GetParticles(lev);
+
+    for (MFIter mfi = MakeMFIter(lev); mfi.isValid(); ++mfi)
+    {
+        auto index = std::make_pair(mfi.index(), mfi.LocalTileIndex());
+        auto& aos = plev[index].GetArrayOfStructs();
+        const size_t np = aos.numParticles();
+        ParticleType* pstruct = aos().dataPtr();
+
+        AMREX_FOR_1D ( np, i,
+        {
+            pstruct[i].rdata(PIdx::ax) = 0.0;
+        });
+    }
+
+    // count every pair once on each side
+    buildHalfNeighborList(CheckPair());
+    forEachNeighborPair([] (ParticleType& p1, ParticleType& p2)
+                        {
+                            p1.rdata(PIdx::ax) += 1.0;
+                            p2.rdata(PIdx::ax) += 1.0;
+                        }, PIdx::ax, 1);
+
+    buildNeighborList(CheckPair());
+
+    for (MFIter mfi = MakeMFIter(lev); mfi.isValid(); ++mfi)
+    {
+        auto index = std::make_pair(mfi.index(), mfi.LocalTileIndex());
+        auto& aos = plev[index].GetArrayOfStructs();
+        const int np = aos.numParticles();
+        ParticleType* pstruct = aos().dataPtr();
+
+        const auto& counts = m_neighbor_list[lev][index].GetCounts();
+        Gpu::HostVector<unsigned int> host_counts(counts.size());
+        Gpu::copy(Gpu::deviceToHost, counts.begin(), counts.end(), host_counts.begin());
+
+        for (int i = 0; i < np; i++)
+        {
+            if (pstruct[i].rdata(PIdx::ax) != static_cast<Real>(host_counts[i]))
+            {
+                amrex::PrintToFile("neighbor_test") << "Half list count does not match for particle " << i << std::endl;
+                amrex::PrintToFile("neighbor_test") << "Half list gives " << pstruct[i].rdata(PIdx::ax) << std::endl;
+                amrex::PrintToFile("neighbor_test") << "Full list gives " << host_counts[i] << std::endl;
+                amrex::Abort();
+            }
+        }
+    }
+
+    amrex::PrintToFile("neighbor_test") << "All the half neighbor list counts match!" << std::endl;
+}
+
+void MDParticleContainer::checkParallelForPairs()
+{
+    BL_PROFILE("MDParticleContainer::checkParallelForPairs");
+
+    const int lev = 0;
+    const Geometry& geom = Geom(lev);
+    auto& plev  = GetParticles(lev);
+
+    for (MFIter mfi = MakeMFIter(lev); mfi.isValid(); ++mfi)
+    {
+        auto index = std::make_pair(mfi.index(), mfi.LocalTileIndex());
+        auto& ptile = plev[index];
+        auto& aos   = ptile.GetArrayOfStructs();
+        const int np = aos.numParticles();
+        const ParticleType* pstruct = aos().dataPtr();
+
+        amrex::Gpu::ManagedVector<unsigned int> d_pair_count(np,0);
+        unsigned int* p_pair_count = d_pair_count.data();
+
+        Box bx = mfi.tilebox();
+        bx.grow(m_num_neighbor_cells);
+
+        ParallelForPairs(ptile, bx, geom,
+                         [=] AMREX_GPU_DEVICE (int i, int j) noexcept
+                         {
+                             if (CheckPair()(pstruct[i], pstruct[j])) {
+                                 Gpu::Atomic::AddNoRet(&(p_pair_count[i]), 1u);
+                             }
+                         }, m_num_neighbor_cells);
+        Gpu::streamSynchronize();
+
+        const auto& counts = m_neighbor_list[lev][index].GetCounts();
+        Gpu::HostVector<unsigned int> host_counts(counts.size());
+        Gpu::copy(Gpu::deviceToHost, counts.begin(), counts.end(), host_counts.begin());
+
+        for (int i = 0; i < np; i++)
+        {
+            if (p_pair_count[i] != host_counts[i])
+            {
+                amrex::PrintToFile("neighbor_test") << "Pair count does not match for particle " << i << std::endl;
+                amrex::PrintToFile("neighbor_test") << "ParallelForPairs gives " << p_pair_count[i] << std::endl;
+                amrex::PrintToFile("neighbor_test") << "Neighbor list gives " << host_counts[i] << std::endl;
+                amrex::Abort();
+            }
+        }
+    }
+
+    amrex::PrintToFile("neighbor_test") << "All the ParallelForPairs counts match!" << std::endl;
+}
+
 void MDParticleContainer::reset_test_id()
 {
     BL_PROFILE("MDParticleContainer::reset_test_id");
@@ -22,6 +22,8 @@ void testNeighborParticles();
 
 void testNeighborList();
 
+void testHalfNeighborList();
+
 int main (int argc, char* argv[])
 {
     amrex::Initialize(argc,argv);
@@ -32,6 +34,11 @@ int main (int argc, char* argv[])
     amrex::PrintToFile("neighbor_test") << "Running neighbor list test \n";
     testNeighborList();
 
+#ifndef AMREX_USE_GPU
+    amrex::PrintToFile("neighbor_test") << "Running half neighbor list test \n";
+    testHalfNeighborList();
+#endif
+
     amrex::Finalize();
 }
 
@@ -140,6 +147,16 @@ void testNeighborParticles ()
     pc.updateNeighbors();
 
     amrex::PrintToFile("neighbor_test") << "Min distance is " << pc.minAndMaxDistance() << ", should be (1, 1) \n";
+
+    amrex::PrintToFile("neighbor_test") << "Max displacement since build is " << pc.maxDisplacementSinceBuild() << ", should be " << 0.3*std::sqrt(3.0) << " \n";
+
+    bool rebuilt = pc.updateVerletNeighborList(CheckPair(), 2.0);
+    amrex::PrintToFile("neighbor_test") << "Verlet list rebuilt with skin 2.0: " << rebuilt << ", should be 0 \n";
+
+    rebuilt = pc.updateVerletNeighborList(CheckPair(), 1.0);
+    amrex::PrintToFile("neighbor_test") << "Verlet list rebuilt with skin 1.0: " << rebuilt << ", should be 1 \n";
+
+    amrex::PrintToFile("neighbor_test") << "Max displacement since build is " << pc.maxDisplacementSinceBuild() << ", should be 0 \n";
 }
 
 void testNeighborList ()
@@ -183,4 +200,46 @@ void testNeighborList ()
     pc.buildNeighborList(CheckPair());
 
     pc.checkNeighborList();
+
+    pc.checkParallelForPairs();
+}
+
+void testHalfNeighborList ()
+{
+    BL_PROFILE("testHalfNeighborList");
+    TestParams params;
+    get_test_params(params, "nbor_list");
+
+    RealBox real_box;
+    for (int n = 0; n < BL_SPACEDIM; n++)
+    {
+        real_box.setLo(n, 0.0);
+        real_box.setHi(n, params.size[n]);
+    }
+
+    IntVect domain_lo(AMREX_D_DECL(0, 0, 0));
+    IntVect domain_hi(AMREX_D_DECL(params.size[0]-1,params.size[1]-1,params.size[2]-1));
+    const Box domain(domain_lo, domain_hi);
+
+    int coord = 0;
+    int is_per[BL_SPACEDIM];
+    for (int i = 0; i < BL_SPACEDIM; i++)
+        is_per[i] = params.is_periodic;
+    Geometry geom(domain, &real_box, coord, is_per);
+
+    BoxArray ba(domain);
+    ba.maxSize(params.max_grid_size);
+    DistributionMapping dm(ba);
+
+    const int ncells = 1;
+    MDParticleContainer pc(geom, dm, ba, ncells);
+    pc.setEnableInverse(true);
+
+    int npc = params.num_ppc;
+    IntVect nppc = IntVect(AMREX_D_DECL(npc, npc, npc));
+
+    pc.InitParticles(nppc, 1.0, 0.0);
+    pc.fillNeighbors();
+
+    pc.checkHalfNeighborList();
 }
@@ -15,9 +15,54 @@ struct TestParams {
   int nz;
   int max_grid_size;
   int nppc;
+  int nrep;
+  bool sort;
   bool verbose;
 };
 
+template <int order, class PC>
+void testShapeFactor (PC& pc, const BoxArray& ba, const DistributionMapping& dmap,
+                      const Geometry& geom, Real total_mass)
+{
+  using ParticleType = typename PC::ParticleType;
+
+  const int ng = (order+1)/2;
+  MultiFab rho(ba, dmap, 1, ng);
+
+  const auto plo = geom.ProbLoArray();
+  const auto dxi = geom.InvCellSizeArray();
+  amrex::ParticleToMesh(pc, rho, 0,
+      [=] AMREX_GPU_DEVICE (const ParticleType& p, amrex::Array4<amrex::Real> const& arr)
+      {
+          amrex_deposit_shape<order>(p, 1, arr, plo, dxi);
+      });
+
+  // The shape factors are a partition of unity, so mass is conserved.
+  const Real mass = rho.sum(0);
+  AMREX_ALWAYS_ASSERT(std::abs(mass - total_mass) < 1.e-10*total_mass);
+
+  MultiFab field(ba, dmap, 1, ng);
+  field.setVal(3.0);
+
+  Real err = 0.0;
+  for (typename PC::ParIterType pti(pc, 0); pti.isValid(); ++pti)
+  {
+      const auto& aos = pti.GetArrayOfStructs();
+      const ParticleType* pstruct = aos().dataPtr();
+      const auto arr = field.const_array(pti);
+      for (int i = 0; i < pti.numParticles(); ++i)
+      {
+          Real val;
+          amrex_interpolate_shape<order>(pstruct[i], 1, arr, plo, dxi, &val);
+          err = std::max(err, std::abs(val - 3.0));
+      }
+  }
+  ParallelDescriptor::ReduceRealMax(err);
+  AMREX_ALWAYS_ASSERT(err < 1.e-12);
+
+  amrex::Print() << "Shape factor of order " << order << " conserves mass\n";
+}
+
 void testParticleMesh(TestParams& parms)
 {
 
@@ -66,9 +111,10 @@ void testParticleMesh(TestParams& parms)
   int nc = 1 + BL_SPACEDIM;
   const auto plo = geom.ProbLoArray();
   const auto dxi = geom.InvCellSizeArray();
-  amrex::ParticleToMesh(myPC, partMF, 0,
-      [=] AMREX_GPU_DEVICE (const MyParticleContainer::ParticleType& p,
-                            amrex::Array4<amrex::Real> const& rho)
+  if (parms.sort) myPC.SortParticlesBySFC();
+
+  auto deposit = [=] AMREX_GPU_DEVICE (const MyParticleContainer::ParticleType& p,
+                                       amrex::Array4<amrex::Real> const& rho)
       {
           amrex::Real lx = (p.pos(0) - plo[0]) * dxi[0] + 0.5;
           amrex::Real ly = (p.pos(1) - plo[1]) * dxi[1] + 0.5;
@@ -105,7 +151,46 @@ void testParticleMesh(TestParams& parms)
                   }
               }
           }
-      });
+      };
+
+  amrex::ParticleToMesh(myPC, partMF, 0, deposit);
+
+  // The buffered and the atomic reduction must deposit the same field.
+  MultiFab atomicMF(ba, dmap, 1 + BL_SPACEDIM, 1);
+  amrex::ParticleToMesh(myPC, atomicMF, 0, deposit, true);
+  MultiFab::Subtract(atomicMF, partMF, 0, 0, atomicMF.nComp(), 0);
+  const Real err = atomicMF.norm0(0, 0) / partMF.norm0(0, 0);
+  AMREX_ALWAYS_ASSERT(err < 1.e-12);
+
+  if (parms.nrep > 0)
+  {
+      Real t_buffered = amrex::second();
+      for (int n = 0; n < parms.nrep; ++n) {
+          amrex::ParticleToMesh(myPC, partMF, 0, deposit, false);
+      }
+      t_buffered = amrex::second() - t_buffered;
+
+      Real t_atomic = amrex::second();
+      for (int n = 0; n < parms.nrep; ++n) {
+          amrex::ParticleToMesh(myPC, atomicMF, 0, deposit, true);
+      }
+      t_atomic = amrex::second() - t_atomic;
+
+      ParallelDescriptor::ReduceRealMax(t_buffered);
+      ParallelDescriptor::ReduceRealMax(t_atomic);
+
+      amrex::Print() << "ParticleToMesh, buffered reduce : "
+                     << num_particles * parms.nrep / t_buffered << " particles/s\n"
+                     << "ParticleToMesh, atomic reduce   : "
+                     << num_particles * parms.nrep / t_atomic << " particles/s\n\n";
+  }
+
+  const Real total_mass = mass * num_particles;
+  testShapeFactor<0>(myPC, ba, dmap, geom, total_mass);
+  testShapeFactor<1>(myPC, ba, dmap, geom, total_mass);
+  testShapeFactor<2>(myPC, ba, dmap, geom, total_mass);
+  testShapeFactor<3>(myPC, ba, dmap, geom, total_mass);
+  testShapeFactor<4>(myPC, ba, dmap, geom, total_mass);
 
   MultiFab acceleration(ba, dmap, BL_SPACEDIM, 1);
   acceleration.setVal(5.0);
@@ -165,6 +250,12 @@ int main(int argc, char* argv[])
   if (parms.nppc < 1 && ParallelDescriptor::IOProcessor())
     amrex::Abort("Must specify at least one particle per cell");
   
+  parms.nrep = 0;
+  pp.query("nrep", parms.nrep);
+
+  parms.sort = false;
+  pp.query("sort", parms.sort);
+
   parms.verbose = false;
   pp.query("verbose", parms.verbose);
   
@@ -3,6 +3,10 @@
 #include <AMReX_MultiFab.H>
 #include <AMReX_Particles.H>
 
+#include <algorithm>
+#include <atomic>
+#include <tuple>
+
 using namespace amrex;
 
 static constexpr int NSR = 6;
@@ -281,6 +285,92 @@ public:
             }
         }
     }
+
+    // Both containers must hold the same particles in the same tiles.
+    void checkSameParticles (const TestParticleContainer& other) const
+    {
+        BL_PROFILE("TestParticleContainer::checkSameParticles");
+
+        using Key = std::tuple<int, int, ParticleReal, ParticleReal, ParticleReal>;
+        auto tile_keys = [] (const ParticleLevel& plev, const std::pair<int,int>& index)
+        {
+            std::vector<Key> keys;
+            auto it = plev.find(index);
+            if (it == plev.end()) return keys;
+            const auto& aos = it->second.GetArrayOfStructs();
+            Gpu::HostVector<ParticleType> host_particles(aos.numParticles());
+            Gpu::copy(Gpu::deviceToHost, aos().begin(), aos().end(), host_particles.begin());
+            for (const auto& p : host_particles) {
+                keys.emplace_back(p.id(), p.cpu(),
+                                  AMREX_D_PICK(p.pos(0), p.pos(1), p.pos(2)),
+                                  AMREX_D_PICK(0, p.pos(0), p.pos(1)),
+                                  AMREX_D_PICK(0, 0, p.pos(0)));
+            }
+            std::sort(keys.begin(), keys.end());
+            return keys;
+        };
+
+        for (int lev = 0; lev <= finestLevel(); ++lev)
+        {
+            for(MFIter mfi = MakeMFIter(lev); mfi.isValid(); ++mfi)
+            {
+                auto index = std::make_pair(mfi.index(), mfi.LocalTileIndex());
+                AMREX_ALWAYS_ASSERT(tile_keys(GetParticles(lev), index) ==
+                                    tile_keys(other.GetParticles(lev), index));
+            }
+        }
+    }
+
+    std::atomic<Long> num_post_locate{0};
+
+    // After SortParticlesBySFC, the Morton keys of the cells must not decrease
+    // within a tile.
+    void checkSFCOrder () const
+    {
+        BL_PROFILE("TestParticleContainer::checkSFCOrder");
+
+        for (int lev = 0; lev <= finestLevel(); ++lev)
+        {
+            const auto dxi = Geom(lev).InvCellSizeArray();
+            const auto plo = Geom(lev).ProbLoArray();
+            const auto domain = Geom(lev).Domain();
+            auto& plev  = GetParticles(lev);
+            for(MFIter mfi = MakeMFIter(lev); mfi.isValid(); ++mfi)
+            {
+                int gid = mfi.index();
+                int tid = mfi.LocalTileIndex();
+                auto& ptile = plev.at(std::make_pair(gid, tid));
+                const auto& aos = ptile.GetArrayOfStructs();
+                const Box box = mfi.validbox();
+                IntVect nbits(0);
+                for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+                    while ((1 << nbits[d]) < box.length(d)) ++nbits[d];
+                }
+
+                Gpu::HostVector<ParticleType> host_particles(aos.numParticles());
+                Gpu::copy(Gpu::deviceToHost, aos().begin(), aos().end(), host_particles.begin());
+
+                unsigned int last = 0;
+                for (const auto& p : host_particles)
+                {
+                    IntVect iv = getParticleCell(p, plo, dxi, domain);
+                    iv.max(box.smallEnd());
+                    iv.min(box.bigEnd());
+                    const unsigned int key = getMortonIndex(iv, box, nbits);
+                    AMREX_ALWAYS_ASSERT(key >= last);
+                    last = key;
+                }
+            }
+        }
+    }
+
+private:
+
+    void particlePostLocate (ParticleType& /*p*/, const ParticleLocData& /*pld*/,
+                             const int /*lev*/) override
+    {
+        ++num_post_locate;
+    }
 };
 
 struct TestParams
@@ -386,11 +476,32 @@ void testRedistribute ()
 
     auto np_old = pc.TotalNumberOfParticles();
 
+    // ---- a copy redistributed with the fast path off must end up the same
+    TestParticleContainer pc_ref(geom, dm, ba, rr);
+    const bool fast = TestParticleContainer::do_fast_redistribute;
+
     for (int i = 0; i < params.nsteps; ++i)
     {
         pc.moveParticles(params.move_dir, params.do_random);
+
+        pc_ref.copyParticles(pc, true);
+        pc_ref.num_post_locate = 0;
+        TestParticleContainer::do_fast_redistribute = false;
+        pc_ref.RedistributeLocal();
+
+        pc.num_post_locate = 0;
+        TestParticleContainer::do_fast_redistribute = true;
         pc.RedistributeLocal();
-        if (params.sort) pc.SortParticlesByCell();
+        TestParticleContainer::do_fast_redistribute = fast;
+
+        pc.checkSameParticles(pc_ref);
+        AMREX_ALWAYS_ASSERT(pc.num_post_locate == pc_ref.num_post_locate);
+
+        if (params.sort == 1) pc.SortParticlesByCell();
+        if (params.sort == 2) {
+            pc.SortParticlesBySFC();
+            pc.checkSFCOrder();
+        }
         pc.checkAnswer();
     }
 
@@ -0,0 +1,139 @@
+//
+// Write plotfiles with a BoxIndex and read subregions of them back with
+// PlotFileData after the FabArray headers (Cell_H) have been moved away,
+// so that any read through them fails.
+//
+
+#include <AMReX.H>
+#include <AMReX_BoxIndex.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_PlotFileUtil.H>
+#include <AMReX_Print.H>
+#include <AMReX_Utility.H>
+#include <AMReX_VisMF.H>
+
+#include <cstdio>
+
+using namespace amrex;
+
+namespace {
+
+AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+Real value (int i, int j, int k, int n) noexcept
+{
+    return Real(1.0) + i + Real(0.1)*j + Real(0.01)*k + Real(1000.)*n;
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int n_cell = 64;
+        int max_grid_size = 16;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+        }
+
+        Box domain(IntVect(0), IntVect(n_cell-1));
+        RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+        Geometry geom(domain, rb, CoordSys::cartesian, {AMREX_D_DECL(0,0,0)});
+        BoxArray ba(domain);
+        ba.maxSize(max_grid_size);
+        DistributionMapping dm(ba);
+
+        const int ncomp = 2;
+        MultiFab mf(ba, dm, ncomp, 0);
+        for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+            auto const& a = mf.array(mfi);
+            amrex::ParallelFor(mfi.validbox(), ncomp,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
+            {
+                a(i,j,k,n) = value(i,j,k,n);
+            });
+        }
+        const Vector<std::string> varnames{"a", "b"};
+
+        // A slab in the middle of the domain
+        Box region = domain;
+        region.setSmall(0, n_cell/2-1);
+        region.setBig(0, n_cell/2);
+
+        const VisMF::Header::Version versions[] = {VisMF::Header::Version_v1,
+                                                   VisMF::Header::NoFabHeader_v1,
+                                                   VisMF::Header::Compressed_v1};
+        const VisMF::Header::Version old_version = VisMF::GetHeaderVersion();
+        const bool old_write_box_index = VisMF::GetWriteBoxIndex();
+        VisMF::SetWriteBoxIndex(true);
+
+        for (auto vers : versions)
+        {
+            const std::string name = "boxindex_plt_v" + std::to_string(static_cast<int>(vers));
+            VisMF::SetHeaderVersion(vers);
+            WriteSingleLevelPlotfile(name, mf, varnames, geom, 0.0, 0);
+
+            const std::string hdr = name + "/Level_0/Cell_H";
+            if (ParallelDescriptor::IOProcessor()) {
+                AMREX_ALWAYS_ASSERT(std::rename(hdr.c_str(), (hdr+".moved").c_str()) == 0);
+            }
+            ParallelDescriptor::Barrier();
+
+            Long nwrong = 0;
+            {
+                PlotFileData pf(name);
+                AMREX_ALWAYS_ASSERT(pf.boxArray(0) == ba);
+
+                Vector<int> expected;
+                for (int i = 0; i < ba.size(); ++i) {
+                    if (ba[i].intersects(region)) expected.push_back(i);
+                }
+                AMREX_ALWAYS_ASSERT(pf.intersections(0, region) == expected);
+
+                for (int n = 0; n < ncomp; ++n) {
+                    MultiFab sub = pf.get(0, varnames[n], region);
+                    AMREX_ALWAYS_ASSERT(sub.size() == static_cast<int>(expected.size()));
+                    for (MFIter mfi(sub); mfi.isValid(); ++mfi) {
+                        AMREX_ALWAYS_ASSERT(region.contains(mfi.validbox()));
+                        auto const& a = sub.const_array(mfi);
+                        amrex::LoopOnCpu(mfi.validbox(), [&] (int i, int j, int k) noexcept
+                        {
+                            if (a(i,j,k) != value(i,j,k,n)) ++nwrong;
+                        });
+                    }
+                }
+            }
+
+            ParallelDescriptor::Barrier();
+            if (ParallelDescriptor::IOProcessor()) {
+                AMREX_ALWAYS_ASSERT(std::rename((hdr+".moved").c_str(), hdr.c_str()) == 0);
+            }
+            ParallelDescriptor::Barrier();
+
+            // With Cell_H back, whole-level reads load it on first use
+            {
+                PlotFileData pf(name);
+                MultiFab whole = pf.get(0, varnames[0]);
+                for (MFIter mfi(whole); mfi.isValid(); ++mfi) {
+                    auto const& a = whole.const_array(mfi);
+                    amrex::LoopOnCpu(mfi.validbox(), [&] (int i, int j, int k) noexcept
+                    {
+                        if (a(i,j,k) != value(i,j,k,0)) ++nwrong;
+                    });
+                }
+            }
+
+            ParallelDescriptor::ReduceLongSum(nwrong);
+            amrex::Print() << "Header version " << static_cast<int>(vers) << ": "
+                           << nwrong << " wrong values\n";
+            AMREX_ALWAYS_ASSERT(nwrong == 0);
+        }
+
+        VisMF::SetHeaderVersion(old_version);
+        VisMF::SetWriteBoxIndex(old_write_box_index);
+    }
+    amrex::Finalize();
+}
@@ -0,0 +1,184 @@
+//
+// Round trips of the lossless compression of FloatCompress, directly and
+// through VisMF with the Compressed_v1 header version.  The data are
+// zero, constant, smooth with NaNs, infinities, negative zeros and
+// denormals, and random bits that do not compress.  The fabs read back
+// must be bit for bit those written, or, with fab.format=IEEE_32 or
+// NATIVE_32, those read back from an uncompressed write.
+//
+
+#include <AMReX.H>
+#include <AMReX_FloatCompress.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+#include <AMReX_VisMF.H>
+
+#include <cstring>
+#include <limits>
+#include <random>
+
+using namespace amrex;
+
+namespace {
+
+enum Pattern { zero_pattern = 0, constant_pattern, special_pattern, random_pattern,
+               smooth_pattern, npatterns };
+
+void fill (FArrayBox& fab, int pattern, unsigned seed)
+{
+    auto const& a = fab.array();
+    const Box& bx = fab.box();
+    const int ncomp = fab.nComp();
+    std::mt19937_64 gen(seed);
+    const Real specials[] = {std::numeric_limits<Real>::quiet_NaN(),
+                             -std::numeric_limits<Real>::quiet_NaN(),
+                             std::numeric_limits<Real>::infinity(),
+                             -std::numeric_limits<Real>::infinity(),
+                             Real(-0.0),
+                             std::numeric_limits<Real>::denorm_min(),
+                             std::numeric_limits<Real>::max()};
+    const int nspecials = sizeof(specials)/sizeof(specials[0]);
+    amrex::LoopOnCpu(bx, ncomp, [&] (int i, int j, int k, int n) noexcept
+    {
+        switch (pattern) {
+        case zero_pattern:
+            a(i,j,k,n) = 0.0;
+            break;
+        case constant_pattern:
+            a(i,j,k,n) = Real(3.25) + n;
+            break;
+        case random_pattern:
+        {
+            std::uint64_t bits = gen();
+            std::memcpy(&a(i,j,k,n), &bits, sizeof(Real));
+            break;
+        }
+        default:
+            a(i,j,k,n) = Real(1.0) + i + Real(0.1)*j + Real(0.01)*k + Real(1000.)*n;
+            if (pattern == special_pattern && gen() % 7 == 0) {
+                a(i,j,k,n) = specials[gen() % nspecials];
+            }
+        }
+    });
+}
+
+bool same_bits (FArrayBox const& a, FArrayBox const& b)
+{
+    return a.box() == b.box() && a.nComp() == b.nComp() &&
+        std::memcmp(a.dataPtr(), b.dataPtr(), a.nBytes()) == 0;
+}
+
+// FloatCompress by itself, including blocks of no and of one word
+Long check_blocks ()
+{
+    Long nwrong = 0;
+    const Long nwords[] = {0, 1, 2, 1000};
+    const int wordsizes[] = {1, 2, 4, 8};
+    std::mt19937_64 gen(42);
+    for (Long nw : nwords) {
+    for (int ws : wordsizes) {
+    for (int pattern = 0; pattern < 3; ++pattern) {
+    for (int flags = 0; flags < 4; ++flags) {
+        const bool msb_first = flags & 1;
+        const bool delta = flags & 2;
+        Vector<char> in(nw*ws);
+        for (Long i = 0; i < nw*ws; ++i) {
+            in[i] = (pattern == 0) ? char(0)
+                  : (pattern == 1) ? static_cast<char>(i % ws)
+                  :                  static_cast<char>(gen());
+        }
+        Vector<char> z;
+        FloatCompress::compress(in.dataPtr(), nw, ws, msb_first, z, delta);
+        Vector<char> out(nw*ws+1, char(-1));
+        if (static_cast<Long>(z.size()) != FloatCompress::blockSize(z.dataPtr())) {
+            ++nwrong;
+        } else {
+            FloatCompress::decompress(z.dataPtr(), out.dataPtr(), nw, ws);
+            if (std::memcmp(in.dataPtr(), out.dataPtr(), nw*ws) != 0 || out[nw*ws] != char(-1)) {
+                ++nwrong;
+            }
+        }
+    }}}}
+    return nwrong;
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int n_cell = 32;
+        int max_grid_size = 8;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+        }
+
+        Long nwrong = 0;
+        if (ParallelDescriptor::IOProcessor()) {
+            nwrong = check_blocks();
+        }
+        ParallelDescriptor::ReduceLongSum(nwrong);
+        amrex::Print() << "FloatCompress blocks: " << nwrong << " wrong\n";
+        AMREX_ALWAYS_ASSERT(nwrong == 0);
+
+        Box domain(IntVect(0), IntVect(n_cell-1));
+        BoxArray ba(domain);
+        ba.maxSize(max_grid_size);
+        MultiFab mf(ba, DistributionMapping(ba), 2, 1);
+        for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+            fill(mf[mfi], mfi.index() % npatterns, mfi.index());
+        }
+        // A single cell, so that with more than one process some have no fabs
+        BoxArray ba_one(Box(IntVect(0), IntVect(0)));
+        MultiFab one(ba_one, DistributionMapping(ba_one), 2, 0);
+        for (MFIter mfi(one); mfi.isValid(); ++mfi) {
+            fill(one[mfi], special_pattern, 7);
+        }
+
+        const VisMF::Header::Version old_version = VisMF::GetHeaderVersion();
+        const FABio::Format old_format = FArrayBox::getFormat();
+
+        const FABio::Format formats[] = {FABio::FAB_NATIVE, FABio::FAB_NATIVE_32,
+                                         FABio::FAB_IEEE_32};
+        for (auto fmt : formats)
+        {
+            FArrayBox::setFormat(fmt);
+            for (MultiFab const* src : {&mf, &one})
+            {
+                const std::string name = "compressed_mf";
+                VisMF::SetHeaderVersion(VisMF::Header::Compressed_v1);
+                VisMF::Write(*src, name);
+                MultiFab mf_z(src->boxArray(), src->DistributionMap(), src->nComp(), src->nGrowVect());
+                VisMF::Read(mf_z, name);
+
+                // The same data through the written RealDescriptor, uncompressed
+                MultiFab mf_ref(src->boxArray(), src->DistributionMap(), src->nComp(), src->nGrowVect());
+                if (fmt == FABio::FAB_NATIVE) {
+                    for (MFIter mfi(mf_ref); mfi.isValid(); ++mfi) {
+                        std::memcpy(mf_ref[mfi].dataPtr(), (*src)[mfi].dataPtr(), mf_ref[mfi].nBytes());
+                    }
+                } else {
+                    VisMF::SetHeaderVersion(VisMF::Header::NoFabHeader_v1);
+                    VisMF::Write(*src, name + "_ref");
+                    VisMF::Read(mf_ref, name + "_ref");
+                }
+
+                for (MFIter mfi(mf_z); mfi.isValid(); ++mfi) {
+                    if (!same_bits(mf_z[mfi], mf_ref[mfi])) ++nwrong;
+                }
+            }
+            ParallelDescriptor::ReduceLongSum(nwrong);
+            amrex::Print() << "Format " << static_cast<int>(fmt) << ": "
+                           << nwrong << " wrong fabs\n";
+            AMREX_ALWAYS_ASSERT(nwrong == 0);
+        }
+
+        VisMF::SetHeaderVersion(old_version);
+        FArrayBox::setFormat(old_format);
+    }
+    amrex::Finalize();
+}
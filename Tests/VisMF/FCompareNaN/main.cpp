@@ -0,0 +1,62 @@
+//
+// Write two plotfiles of constant data that differ only by a NaN in one
+// fab, for fcompare to compare.  The min and max of that fab in the
+// header ignore the NaN, so the headers show both files to be the same
+// constant.
+//
+
+#include <AMReX.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_PlotFileUtil.H>
+#include <AMReX_Print.H>
+
+#include <limits>
+
+using namespace amrex;
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int n_cell = 32;
+        int max_grid_size = 16;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+        }
+
+        Box domain(IntVect(0), IntVect(n_cell-1));
+        RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+        Geometry geom(domain, rb, CoordSys::cartesian, {AMREX_D_DECL(0,0,0)});
+        BoxArray ba(domain);
+        ba.maxSize(max_grid_size);
+        DistributionMapping dm(ba);
+
+        MultiFab mf(ba, dm, 1, 0);
+        mf.setVal(1.0);
+        const Vector<std::string> varnames{"a"};
+        WriteSingleLevelPlotfile("fcompare_nan_a", mf, varnames, geom, 0.0, 0);
+
+        // A NaN in the last cell of the first fab
+        const Box bx0 = ba[0];
+        const IntVect iv = bx0.bigEnd();
+        for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+            if (mfi.index() == 0) {
+                mf[mfi](iv) = std::numeric_limits<Real>::quiet_NaN();
+            }
+        }
+        WriteSingleLevelPlotfile("fcompare_nan_b", mf, varnames, geom, 0.0, 0);
+
+        PlotFileData pf_a("fcompare_nan_a");
+        PlotFileData pf_b("fcompare_nan_b");
+        Real mn_a, mx_a, mn_b, mx_b;
+        AMREX_ALWAYS_ASSERT(pf_a.fabMinMax(0, 0, "a", mn_a, mx_a) &&
+                            pf_b.fabMinMax(0, 0, "a", mn_b, mx_b));
+        amrex::Print() << "Header min and max of the fab with the NaN: "
+                       << mn_b << " " << mx_b << "\n";
+        AMREX_ALWAYS_ASSERT(mn_a == 1.0 && mx_a == 1.0);
+    }
+    amrex::Finalize();
+}
@@ -0,0 +1,128 @@
+//
+// Write MultiFabs with each header version and read them back in file
+// order (vismf.usesynchronousreads=1), into a MultiFab defined by the
+// reader and into MultiFabs with other DistributionMappings and fewer
+// components and ghost cells.  With mode = write or mode = read, only
+// that half is done, so that the two can be run with different numbers
+// of processes.  The MultiFabs are named prefix_v<header version>.
+//
+
+#include <AMReX.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+#include <AMReX_VisMF.H>
+
+using namespace amrex;
+
+namespace {
+
+AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+Real value (int i, int j, int k, int n) noexcept
+{
+    return Real(1.0) + i + Real(0.1)*j + Real(0.01)*k + Real(1000.)*n;
+}
+
+Long num_wrong (MultiFab const& mf)
+{
+    Long nwrong = 0;
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        auto const& a = mf.const_array(mfi);
+        amrex::LoopOnCpu(mfi.fabbox(), mf.nComp(), [&] (int i, int j, int k, int n) noexcept
+        {
+            if (a(i,j,k,n) != value(i,j,k,n)) ++nwrong;
+        });
+    }
+    ParallelDescriptor::ReduceLongSum(nwrong);
+    return nwrong;
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int n_cell = 32;
+        int max_grid_size = 8;
+        std::string mode = "both";
+        std::string prefix = "fileorder_mf";
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("mode", mode);
+            pp.query("prefix", prefix);
+        }
+        AMREX_ALWAYS_ASSERT(mode == "both" || mode == "write" || mode == "read");
+
+        Box domain(IntVect(0), IntVect(n_cell-1));
+        BoxArray ba(domain);
+        ba.maxSize(max_grid_size);
+
+        const int ncomp = 3;
+        const int ngrow = 2;
+
+        const VisMF::Header::Version versions[] = {VisMF::Header::Version_v1,
+                                                   VisMF::Header::NoFabHeader_v1,
+                                                   VisMF::Header::NoFabHeaderMinMax_v1,
+                                                   VisMF::Header::NoFabHeaderFAMinMax_v1,
+                                                   VisMF::Header::Compressed_v1};
+        const VisMF::Header::Version old_version = VisMF::GetHeaderVersion();
+        const bool old_sync_reads = VisMF::GetUseSynchronousReads();
+
+        for (auto vers : versions)
+        {
+            const std::string name = prefix + "_v" + std::to_string(static_cast<int>(vers));
+
+            if (mode != "read") {
+                MultiFab mf(ba, DistributionMapping(ba), ncomp, ngrow);
+                for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+                    auto const& a = mf.array(mfi);
+                    amrex::ParallelFor(mfi.fabbox(), ncomp,
+                    [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
+                    {
+                        a(i,j,k,n) = value(i,j,k,n);
+                    });
+                }
+                VisMF::SetHeaderVersion(vers);
+                VisMF::Write(mf, name);
+            }
+
+            if (mode != "write") {
+                VisMF::SetUseSynchronousReads(true);
+                const int nprocs = ParallelDescriptor::NProcs();
+
+                // The reader defines the MultiFab.
+                MultiFab mf0;
+                VisMF::Read(mf0, name);
+                AMREX_ALWAYS_ASSERT(mf0.nComp() == ncomp && mf0.nGrowVect() == IntVect(ngrow));
+                Long nwrong = num_wrong(mf0);
+
+                // Another DistributionMapping, and fewer components and
+                // ghost cells than in the file
+                Vector<int> pmap(ba.size());
+                for (int i = 0; i < ba.size(); ++i) {
+                    pmap[i] = (ba.size() - 1 - i) % nprocs;
+                }
+                DistributionMapping dm(std::move(pmap));
+                for (int nc = ncomp-1; nc <= ncomp; ++nc) {
+                    for (int ng = 0; ng <= ngrow; ++ng) {
+                        MultiFab mf(ba, dm, nc, ng);
+                        mf.setVal(-1.0);
+                        VisMF::Read(mf, name);
+                        nwrong += num_wrong(mf);
+                    }
+                }
+
+                amrex::Print() << "Header version " << static_cast<int>(vers) << ": "
+                               << nwrong << " wrong values\n";
+                AMREX_ALWAYS_ASSERT(nwrong == 0);
+            }
+        }
+
+        VisMF::SetHeaderVersion(old_version);
+        VisMF::SetUseSynchronousReads(old_sync_reads);
+    }
+    amrex::Finalize();
+}
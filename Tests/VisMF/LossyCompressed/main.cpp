@@ -0,0 +1,156 @@
+//
+// Write plotfiles with error bounds (VisMF::Header::LossyCompressed_v1)
+// and check that every value read back is within the bound of its
+// variable.  The variables are smooth, noisy, and smooth with NaNs and
+// infinities, which must come back as they were.  A variable with a zero
+// bound and a plotfile written without bounds must come back exactly.
+//
+
+#include <AMReX.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_PlotFileUtil.H>
+#include <AMReX_Print.H>
+#include <AMReX_VisMF.H>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+
+using namespace amrex;
+
+namespace {
+
+Real smooth (int i, int j, int k, int n)
+{
+    return std::sin(Real(0.1)*i + n) * std::cos(Real(0.07)*j) + Real(0.01)*k;
+}
+
+// Number of values of mf_b not within errbound[n] of those of mf_a.  NaNs
+// and infinities must match exactly.
+Long num_wrong (MultiFab const& mf_a, MultiFab const& mf_b, Vector<Real> const& errbound)
+{
+    Long nwrong = 0;
+    for (MFIter mfi(mf_a); mfi.isValid(); ++mfi) {
+        auto const& a = mf_a.const_array(mfi);
+        auto const& b = mf_b.const_array(mfi);
+        amrex::LoopOnCpu(mfi.validbox(), mf_a.nComp(), [&] (int i, int j, int k, int n) noexcept
+        {
+            const Real va = a(i,j,k,n);
+            const Real vb = b(i,j,k,n);
+            bool ok;
+            if (std::isnan(va)) {
+                ok = std::isnan(vb);
+            } else if (std::isinf(va)) {
+                ok = (va == vb);
+            } else if (errbound[n] == 0.0) {
+                ok = std::memcmp(&va, &vb, sizeof(Real)) == 0;
+            } else {
+                ok = std::abs(vb - va) <= errbound[n];
+            }
+            if (!ok) ++nwrong;
+        });
+    }
+    ParallelDescriptor::ReduceLongSum(nwrong);
+    return nwrong;
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int n_cell = 32;
+        int max_grid_size = 16;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+        }
+
+        Box domain(IntVect(0), IntVect(n_cell-1));
+        RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+        Geometry geom(domain, rb, CoordSys::cartesian, {AMREX_D_DECL(0,0,0)});
+        BoxArray ba(domain);
+        ba.maxSize(max_grid_size);
+        DistributionMapping dm(ba);
+
+        const Vector<std::string> varnames{"smooth", "noisy", "special", "exact"};
+        const int ncomp = varnames.size();
+        MultiFab mf(ba, dm, ncomp, 0);
+        for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+            auto const& a = mf.array(mfi);
+            std::mt19937 gen(mfi.index());
+            std::uniform_real_distribution<double> noise(-1.0, 1.0);
+            amrex::LoopOnCpu(mfi.validbox(), [&] (int i, int j, int k) noexcept
+            {
+                a(i,j,k,0) = smooth(i,j,k,0);
+                a(i,j,k,1) = static_cast<Real>(noise(gen));
+                a(i,j,k,2) = smooth(i,j,k,2);
+                if (gen() % 13 == 0) a(i,j,k,2) = std::numeric_limits<Real>::quiet_NaN();
+                if (gen() % 17 == 0) a(i,j,k,2) = -std::numeric_limits<Real>::infinity();
+                a(i,j,k,3) = smooth(i,j,k,3);
+            });
+        }
+
+        Long nwrong = 0;
+
+        // Plotfiles are lossless by default.
+        {
+            WriteSingleLevelPlotfile("lossy_plt_default", mf, varnames, geom, 0.0, 0);
+            PlotFileData pf("lossy_plt_default");
+            MultiFab mf_r(ba, dm, ncomp, 0);
+            for (int n = 0; n < ncomp; ++n) {
+                AMREX_ALWAYS_ASSERT(pf.errorBound(0, varnames[n]) == 0.0);
+                MultiFab::Copy(mf_r, pf.get(0, varnames[n]), 0, n, 1, 0);
+            }
+            nwrong += num_wrong(mf, mf_r, Vector<Real>(ncomp, 0.0));
+            amrex::Print() << "Without bounds: " << nwrong << " wrong values\n";
+            AMREX_ALWAYS_ASSERT(nwrong == 0);
+        }
+
+        // An absolute bound, relative bounds and no bound
+        {
+            const Vector<Real> abs_bounds{1.e-3, 0.0, 0.0, 0.0};
+            const Vector<Real> rel_bounds{0.0, 1.e-2, 1.e-4, 0.0};
+            const Vector<Real> errbound = PlotfileErrorBounds(1, {&mf}, abs_bounds, rel_bounds);
+            // The range of special is infinite and gives no bound.
+            AMREX_ALWAYS_ASSERT(errbound.size() == ncomp && errbound[0] == 1.e-3 &&
+                                errbound[1] > 0.0 && errbound[2] == 0.0 &&
+                                errbound[3] == 0.0);
+
+            WriteSingleLevelPlotfile("lossy_plt", mf, varnames, geom, 0.0, 0,
+                                     "HyperCLaw-V1.1", "Level_", "Cell", {}, errbound);
+            PlotFileData pf("lossy_plt");
+            MultiFab mf_r(ba, dm, ncomp, 0);
+            for (int n = 0; n < ncomp; ++n) {
+                AMREX_ALWAYS_ASSERT(pf.errorBound(0, varnames[n]) == errbound[n]);
+                MultiFab::Copy(mf_r, pf.get(0, varnames[n]), 0, n, 1, 0);
+            }
+            nwrong += num_wrong(mf, mf_r, errbound);
+            amrex::Print() << "With bounds: " << nwrong << " wrong values\n";
+            AMREX_ALWAYS_ASSERT(nwrong == 0);
+        }
+
+        // VisMF with a single bound for all components
+        {
+            const VisMF::Header::Version old_version = VisMF::GetHeaderVersion();
+            const Vector<Real> old_errbound = VisMF::GetErrorBounds();
+            const Vector<Real> errbound(ncomp, 1.e-5);
+            VisMF::SetHeaderVersion(VisMF::Header::LossyCompressed_v1);
+            VisMF::SetErrorBounds({errbound[0]});
+            VisMF::Write(mf, "lossy_mf");
+            VisMF::SetHeaderVersion(old_version);
+            VisMF::SetErrorBounds(old_errbound);
+
+            MultiFab mf_r(ba, dm, ncomp, 0);
+            VisMF::Read(mf_r, "lossy_mf");
+            nwrong += num_wrong(mf, mf_r, errbound);
+            amrex::Print() << "VisMF: " << nwrong << " wrong values\n";
+            AMREX_ALWAYS_ASSERT(nwrong == 0);
+        }
+    }
+    amrex::Finalize();
+}
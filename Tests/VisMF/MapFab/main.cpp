@@ -0,0 +1,121 @@
+//
+// Write a MultiFab with different VisMF header versions and read its fabs
+// back with VisMF::mapFAB.  The data must be right whether or not they are
+// aliased, all fabs must be aliased for the versions without fab headers,
+// and writing to a mapped fab must neither fault nor change the file.
+//
+
+#include <AMReX.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+#include <AMReX_VisMF.H>
+
+#include <memory>
+
+using namespace amrex;
+
+namespace {
+
+AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+Real value (int i, int j, int k, int n) noexcept
+{
+    return Real(1.0) + i + Real(0.1)*j + Real(0.01)*k + Real(1000.)*n;
+}
+
+Long num_wrong (FArrayBox const& fab, Box const& bx, int scomp, int ncomp)
+{
+    auto const& a = fab.const_array();
+    Long nwrong = 0;
+    amrex::LoopOnCpu(bx, ncomp, [&] (int i, int j, int k, int n) noexcept
+    {
+        if (a(i,j,k,n) != value(i,j,k,n+scomp)) ++nwrong;
+    });
+    return nwrong;
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int n_cell = 32;
+        int max_grid_size = 16;
+        int ncomp = 3;
+        int nghost = 1;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("ncomp", ncomp);
+            pp.query("nghost", nghost);
+        }
+
+        BoxArray ba(Box(IntVect(0), IntVect(n_cell-1)));
+        ba.maxSize(max_grid_size);
+        DistributionMapping dm(ba);
+        MultiFab mf(ba, dm, ncomp, nghost);
+
+        for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+            auto const& a = mf.array(mfi);
+            amrex::ParallelFor(mfi.fabbox(), ncomp,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
+            {
+                a(i,j,k,n) = value(i,j,k,n);
+            });
+        }
+
+        const VisMF::Header::Version versions[] = {VisMF::Header::Version_v1,
+                                                   VisMF::Header::NoFabHeader_v1,
+                                                   VisMF::Header::NoFabHeaderMinMax_v1};
+        const VisMF::Header::Version old_version = VisMF::GetHeaderVersion();
+
+        for (auto vers : versions)
+        {
+            const std::string name = "mapfab_v" + std::to_string(static_cast<int>(vers));
+            VisMF::SetHeaderVersion(vers);
+            VisMF::Write(mf, name);
+
+            VisMF vismf(name);
+            Long nwrong = 0;
+            int nfabs = 0;
+            int naliased = 0;
+            for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+            {
+                const Box& bx = mfi.fabbox();
+                const int gid = mfi.index();
+                ++nfabs;
+
+                bool zero_copy = false;
+                FArrayBox fab = vismf.mapFAB(gid, -1, &zero_copy);
+                nwrong += num_wrong(fab, bx, 0, ncomp);
+                if (zero_copy) ++naliased;
+
+                const int icomp = ncomp-1;
+                FArrayBox fabcomp = vismf.mapFAB(gid, icomp);
+                nwrong += num_wrong(fabcomp, bx, icomp, 1);
+
+                // This must not fault, and the file must not change.
+                fab.setVal<RunOn::Host>(-1.0);
+                std::unique_ptr<FArrayBox> fromfile(vismf.readFAB(gid, -1));
+                nwrong += num_wrong(*fromfile, bx, 0, ncomp);
+            }
+
+            ParallelDescriptor::ReduceLongSum(nwrong);
+            ParallelDescriptor::ReduceIntSum(nfabs);
+            ParallelDescriptor::ReduceIntSum(naliased);
+
+            amrex::Print() << "Header version " << static_cast<int>(vers) << ": "
+                           << naliased << " of " << nfabs << " fabs mapped without copy\n";
+
+            AMREX_ALWAYS_ASSERT(nwrong == 0);
+            if (vers != VisMF::Header::Version_v1) {
+                AMREX_ALWAYS_ASSERT(naliased == nfabs);
+            }
+        }
+
+        VisMF::SetHeaderVersion(old_version);
+    }
+    amrex::Finalize();
+}
@@ -2,7 +2,9 @@
 #include <AMReX_Print.H>
 #include <AMReX_PlotFileUtil.H>
 #include <algorithm>
+#include <fstream>
 #include <limits>
+#include <map>
 #include <cmath>
 #include <cstdlib>
 
@@ -15,6 +17,133 @@ struct ErrZone {
     IntVect cell;
 };
 
+// Norms of B - A and of A over some fabs.
+struct FabDiff {
+    Real max_diff = 0.0;
+    Real sum_diff = 0.0;
+    Real sum_diff2 = 0.0;
+    Real max_a = 0.0;
+    Real sum_a = 0.0;
+    Real sum_a2 = 0.0;
+    int nan_a = false;
+    int nan_b = false;
+};
+
+// Compare a variable on a level whose grids match fab by fab.  Each process
+// compares the fabs it owns in pf_a's DistributionMapping, reading them
+// straight from the files.  Every fab is read, even if the headers show it
+// to be constant: the min and max in the headers ignore NaN.
+FabDiff compare_fabs (PlotFileData& pf_a, PlotFileData& pf_b, int ilev,
+                      std::string const& name_a, std::string const& name_b)
+{
+    FabDiff r;
+    const BoxArray& ba = pf_a.boxArray(ilev);
+    const DistributionMapping& dmap = pf_a.DistributionMap(ilev);
+    const int myproc = ParallelDescriptor::MyProc();
+
+    for (int gid = 0, N = ba.size(); gid < N; ++gid) {
+        if (dmap[gid] != myproc) continue;
+        const Box& bx = ba[gid];
+
+        FArrayBox fab_a = pf_a.getFab(ilev, gid, name_a);
+        FArrayBox fab_b = pf_b.getFab(ilev, gid, name_b);
+        auto const& a = fab_a.const_array();
+        auto const& b = fab_b.const_array();
+        const auto lo = amrex::lbound(bx);
+        const auto hi = amrex::ubound(bx);
+
+        Real max_diff = 0.0, sum_diff = 0.0, sum_diff2 = 0.0;
+        Real max_a = 0.0, sum_a = 0.0, sum_a2 = 0.0;
+        int nan_a = false, nan_b = false;
+#ifdef AMREX_USE_OMP
+#pragma omp parallel for collapse(2) reduction(max:max_diff,max_a) \
+                                     reduction(+:sum_diff,sum_diff2,sum_a,sum_a2) \
+                                     reduction(||:nan_a,nan_b)
+#endif
+        for (int k = lo.z; k <= hi.z; ++k) {
+        for (int j = lo.y; j <= hi.y; ++j) {
+        for (int i = lo.x; i <= hi.x; ++i) {
+            const Real va = a(i,j,k);
+            const Real vb = b(i,j,k);
+            nan_a = nan_a || std::isnan(va);
+            nan_b = nan_b || std::isnan(vb);
+            const Real d = std::abs(vb - va);
+            max_diff = std::max(max_diff, d);
+            sum_diff += d;
+            sum_diff2 += d*d;
+            max_a = std::max(max_a, std::abs(va));
+            sum_a += std::abs(va);
+            sum_a2 += va*va;
+        }}}
+
+        r.max_diff = std::max(r.max_diff, max_diff);
+        r.sum_diff += sum_diff;
+        r.sum_diff2 += sum_diff2;
+        r.max_a = std::max(r.max_a, max_a);
+        r.sum_a += sum_a;
+        r.sum_a2 += sum_a2;
+        r.nan_a = r.nan_a || nan_a;
+        r.nan_b = r.nan_b || nan_b;
+    }
+
+    Real rmax[] = {r.max_diff, r.max_a};
+    Real rsum[] = {r.sum_diff, r.sum_diff2, r.sum_a, r.sum_a2};
+    int isum[] = {r.nan_a, r.nan_b};
+    ParallelDescriptor::ReduceRealMax(rmax, 2);
+    ParallelDescriptor::ReduceRealSum(rsum, 4);
+    ParallelDescriptor::ReduceIntSum(isum, 2);
+    r.max_diff = rmax[0];
+    r.max_a = rmax[1];
+    r.sum_diff = rsum[0];
+    r.sum_diff2 = rsum[1];
+    r.sum_a = rsum[2];
+    r.sum_a2 = rsum[3];
+    r.nan_a = isum[0] > 0;
+    r.nan_b = isum[1] > 0;
+    return r;
+}
+
+// A lower bound on max |B - A| of a variable on a level whose grids match,
+// from the min and max of each fab in the headers, and max |A| from the
+// headers.  Return false if the headers do not have them.
+bool header_error (PlotFileData const& pf_a, PlotFileData const& pf_b, int ilev,
+                   std::string const& name_a, std::string const& name_b,
+                   Real& lower_bound, Real& max_a)
+{
+    Real mn, mx;
+    if (!pf_a.minMax(ilev, name_a, mn, mx)) return false;
+    max_a = std::max(std::abs(mn), std::abs(mx));
+
+    lower_bound = 0.0;
+    for (int gid = 0, N = pf_a.boxArray(ilev).size(); gid < N; ++gid) {
+        Real mn_a, mx_a, mn_b, mx_b;
+        if (!pf_a.fabMinMax(ilev, gid, name_a, mn_a, mx_a) ||
+            !pf_b.fabMinMax(ilev, gid, name_b, mn_b, mx_b)) {
+            return false;
+        }
+        lower_bound = std::max({lower_bound, std::abs(mn_b-mn_a), std::abs(mx_b-mx_a)});
+    }
+    return true;
+}
+
+std::string json_string (std::string const& s)
+{
+    std::string r = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') r += '\\';
+        r += c;
+    }
+    return r + "\"";
+}
+
+std::string json_number (Real x)
+{
+    if (std::isnan(x) || std::isinf(x)) return "null";
+    std::ostringstream os;
+    os << std::setprecision(17) << x;
+    return os.str();
+}
+
 int main_main()
 {
     const int narg = amrex::command_argument_count();
@@ -38,6 +167,15 @@ int main_main()
     std::string zone_info_var_name;
     Vector<std::string> plot_names(1);
     bool abort_if_not_all_found = false;
+    bool check_bound = false;
+    bool bound_exceeded = false;
+    std::map<std::string,Real> var_atol;
+    std::map<std::string,Real> var_rtol;
+    int max_failures = 0;
+    std::string json_file;
+    int nfailures = 0;
+    bool stopped_early = false;
+    std::ostringstream json_levels;
 
     int farg = 1;
     while (farg <= narg) {
@@ -60,6 +198,18 @@ int main_main()
             rtol = std::stod(amrex::get_command_argument(++farg));
         } else if (fname == "--abs_tol") {
             atol = std::stod(amrex::get_command_argument(++farg));
+        } else if (fname == "--var_abs_tol") {
+            const std::string var = amrex::get_command_argument(++farg);
+            var_atol[var] = std::stod(amrex::get_command_argument(++farg));
+        } else if (fname == "--var_rel_tol") {
+            const std::string var = amrex::get_command_argument(++farg);
+            var_rtol[var] = std::stod(amrex::get_command_argument(++farg));
+        } else if (fname == "--max_failures") {
+            max_failures = std::stoi(amrex::get_command_argument(++farg));
+        } else if (fname == "--json") {
+            json_file = amrex::get_command_argument(++farg);
+        } else if (fname == "-b" || fname == "--check_bound") {
+            check_bound = true;
         } else if (fname == "--abort_if_not_all_found") {
             abort_if_not_all_found = true;            
         } else {
@@ -83,7 +233,7 @@ int main_main()
             << " variable.\n"
             << "\n"
             << " usage:\n"
-            << "    fcompare [-n|--norm num] [-d|--diffvar var] [-z|--zone_info var] [-a|--allow_diff_grids] [-r|rel_tol] [--abs_tol] file1 file2\n"
+            << "    fcompare [-n|--norm num] [-d|--diffvar var] [-z|--zone_info var] [-a|--allow_diff_grids] [-r|rel_tol] [--abs_tol] [--var_abs_tol var atol] [--var_rel_tol var rtol] [--max_failures num] [--json file] [-b|--check_bound] file1 file2\n"
             << "\n"
             << " optional arguments:\n"
             << "    -n|--norm num         : what norm to use (default is 0 for inf norm)\n"
@@ -94,6 +244,20 @@ int main_main()
             << "    -a|--allow_diff_grids : allow different BoxArrays covering the same domain\n"
             << "    -r|--rel_tol rtol     : relative tolerance (default is 0)\n"
             << "    --abs_tol atol        : absolute tolerance (default is 0)\n"
+            << "    --var_abs_tol var atol: absolute tolerance for variable var\n"
+            << "    --var_rel_tol var rtol: relative tolerance for variable var\n"
+            << "    --max_failures num    : stop after num variables on a level fail\n"
+            << "    --json file           : write the errors of each variable on each\n"
+            << "                            level to file in JSON\n"
+            << "    -b|--check_bound      : check that the maximum absolute error of each\n"
+            << "                            variable is within the error bound recorded\n"
+            << "                            for lossy compressed data (0 otherwise)\n"
+            << "\n"
+            << " With per variable tolerances or --max_failures, a variable fails on a\n"
+            << " level if it has NaNs in only one file, or if both its absolute and its\n"
+            << " relative error exceed its tolerances.  The files agree if none fail.\n"
+            << " With --max_failures and the inf norm, a variable may be found to fail\n"
+            << " from the min and max of each fab in the headers without reading it.\n"
             << std::endl;
         return 0;
     }
@@ -204,63 +368,110 @@ int main_main()
         Vector<Real> rerror_denom(ncomp_a, 0.0);
         Vector<int> has_nan_a(ncomp_a, false);
         Vector<int> has_nan_b(ncomp_a, false);
-        for (int icomp_a = 0; icomp_a < ncomp_a; ++icomp_a) {
+        Vector<Real> max_error(ncomp_a, 0.0);
+        Vector<Real> error_bound(ncomp_a, 0.0);
+        Vector<int> compared(ncomp_a, false);
+        Vector<int> from_header(ncomp_a, false);
+        Vector<int> failed(ncomp_a, false);
+        for (int icomp_a = 0; icomp_a < ncomp_a && !stopped_early; ++icomp_a) {
             if (ivar_b[icomp_a] >= 0) {
-                const MultiFab& mf_a = pf_a.get(ilev, names_a[icomp_a]);
-                MultiFab mf_b;
-                if (grids_match) {
-                    mf_b = pf_b.get(ilev, names_b[ivar_b[icomp_a]]);
-                } else {
-                    mf_b.define(mf_a.boxArray(), mf_a.DistributionMap(), 1, 0);
-                    MultiFab tmp = pf_b.get(ilev, names_b[ivar_b[icomp_a]]);
-                    mf_b.ParallelCopy(tmp);
+                const std::string& name_a = names_a[icomp_a];
+                const std::string& name_b = names_b[ivar_b[icomp_a]];
+                const Real atol_a = var_atol.count(name_a) ? var_atol[name_a] : atol;
+                const Real rtol_a = var_rtol.count(name_a) ? var_rtol[name_a] : rtol;
+                error_bound[icomp_a] = std::max(pf_a.errorBound(ilev, name_a),
+                                                pf_b.errorBound(ilev, name_b));
+                Real lower_bound, max_a;
+                if (max_failures > 0 && norm == 0 && grids_match &&
+                    header_error(pf_a, pf_b, ilev, name_a, name_b, lower_bound, max_a) &&
+                    lower_bound > atol_a && lower_bound > rtol_a*max_a)
+                {
+                    max_error[icomp_a] = lower_bound;
+                    aerror[icomp_a] = lower_bound;
+                    rerror_denom[icomp_a] = max_a;
+                    from_header[icomp_a] = true;
                 }
-                has_nan_a[icomp_a] = mf_a.contains_nan();
-                has_nan_b[icomp_a] = mf_b.contains_nan();
-                MultiFab::Subtract(mf_b,mf_a,0,0,1,0); // b = b - a
-                Real max_err = mf_b.norm0();
-                if (norm == 1) {
-                    aerror[icomp_a] = mf_b.norm1();
-                    rerror[icomp_a] = aerror[icomp_a];
-                    rerror_denom[icomp_a] = mf_a.norm1();
-                } else if (norm == 2) {
-                    aerror[icomp_a] = mf_b.norm2();
-                    rerror[icomp_a] = aerror[icomp_a];
-                    rerror_denom[icomp_a] = mf_a.norm2();
-                } else {
-                    aerror[icomp_a] = max_err;
-                    rerror[icomp_a] = aerror[icomp_a];
-                    rerror_denom[icomp_a] = mf_a.norm0();
+                else if (grids_match && icomp_a != save_var_a && icomp_a != zone_info_var_a)
+                {
+                    FabDiff d = compare_fabs(pf_a, pf_b, ilev, name_a, name_b);
+                    has_nan_a[icomp_a] = d.nan_a;
+                    has_nan_b[icomp_a] = d.nan_b;
+                    max_error[icomp_a] = d.max_diff;
+                    if (norm == 1) {
+                        aerror[icomp_a] = d.sum_diff;
+                        rerror_denom[icomp_a] = d.sum_a;
+                    } else if (norm == 2) {
+                        aerror[icomp_a] = std::sqrt(d.sum_diff2);
+                        rerror_denom[icomp_a] = std::sqrt(d.sum_a2);
+                    } else {
+                        aerror[icomp_a] = d.max_diff;
+                        rerror_denom[icomp_a] = d.max_a;
+                    }
+                }
+                else
+                {
+                    const MultiFab& mf_a = pf_a.get(ilev, name_a);
+                    MultiFab mf_b;
+                    if (grids_match) {
+                        mf_b = pf_b.get(ilev, name_b);
+                    } else {
+                        mf_b.define(mf_a.boxArray(), mf_a.DistributionMap(), 1, 0);
+                        MultiFab tmp = pf_b.get(ilev, name_b);
+                        mf_b.ParallelCopy(tmp);
+                    }
+                    has_nan_a[icomp_a] = mf_a.contains_nan();
+                    has_nan_b[icomp_a] = mf_b.contains_nan();
+                    MultiFab::Subtract(mf_b,mf_a,0,0,1,0); // b = b - a
+                    Real max_err = mf_b.norm0();
+                    max_error[icomp_a] = max_err;
+                    if (norm == 1) {
+                        aerror[icomp_a] = mf_b.norm1();
+                        rerror_denom[icomp_a] = mf_a.norm1();
+                    } else if (norm == 2) {
+                        aerror[icomp_a] = mf_b.norm2();
+                        rerror_denom[icomp_a] = mf_a.norm2();
+                    } else {
+                        aerror[icomp_a] = max_err;
+                        rerror_denom[icomp_a] = mf_a.norm0();
+                    }
+
+                    if (icomp_a == save_var_a || icomp_a == zone_info_var_a) {
+                        mf_b.abs(0,1);
+                    }
+
+                    if (icomp_a == save_var_a) {
+                        MultiFab::Copy(mf_array[ilev], mf_b, 0, 0, 1, 0);
+                    }
+
+                    if (icomp_a == zone_info_var_a) {
+                        if (max_err > err_zone.max_abs_err) {
+                            err_zone.max_abs_err = max_err;
+                            err_zone.level = ilev;
+                            err_zone.cell = mf_b.maxIndex(0);
+                            auto isects = pf_a.boxArray(ilev).intersections
+                                (Box(err_zone.cell,err_zone.cell), true, 0);
+                            err_zone.grid_index = isects[0].first;
+                        }
+                    }
                 }
 
-                if (norm == 0) {
-                    rerror[icomp_a] /= rerror_denom[icomp_a];
-                } else {
+                rerror[icomp_a] = aerror[icomp_a]/rerror_denom[icomp_a];
+                if (norm != 0) {
                     const auto& dx = pf_a.cellSize(ilev);
                     Real dv = 1.0;
                     for (int idim = 0; idim < dm; ++idim) {
                         dv *= dx[idim];
                     }
                     aerror[icomp_a] *= std::pow(dv,1./static_cast<Real>(norm));
-                    rerror[icomp_a] = rerror[icomp_a]/rerror_denom[icomp_a];
-                }
-
-                if (icomp_a == save_var_a || icomp_a == zone_info_var_a) {
-                    mf_b.abs(0,1);
                 }
 
-                if (icomp_a == save_var_a) {
-                    MultiFab::Copy(mf_array[ilev], mf_b, 0, 0, 1, 0);
-                }
-
-                if (icomp_a == zone_info_var_a) {
-                    if (max_err > err_zone.max_abs_err) {
-                        err_zone.max_abs_err = max_err;
-                        err_zone.level = ilev;
-                        err_zone.cell = mf_b.maxIndex(0);
-                        auto isects = pf_a.boxArray(ilev).intersections
-                            (Box(err_zone.cell,err_zone.cell), true, 0);
-                        err_zone.grid_index = isects[0].first;
+                compared[icomp_a] = true;
+                failed[icomp_a] = (has_nan_a[icomp_a] != has_nan_b[icomp_a]) ||
+                    (aerror[icomp_a] > atol_a && rerror[icomp_a] > rtol_a);
+                if (failed[icomp_a]) {
+                    ++nfailures;
+                    if (max_failures > 0 && nfailures >= max_failures) {
+                        stopped_early = true;
                     }
                 }
             }
@@ -272,6 +483,8 @@ int main_main()
                 amrex::Print() << " " << std::setw(24) << std::left << names_a[icomp_a]
                                << "  " << std::setw(50)
                                << "< variable not present in both files > \n";
+            } else if (!compared[icomp_a]) {
+                continue;
             } else if (has_nan_a[icomp_a] && has_nan_b[icomp_a]) {
                 amrex::Print() << " " << std::setw(24) << std::left << names_a[icomp_a]
                                << "  " << std::setw(50)
@@ -300,10 +513,46 @@ int main_main()
                                << std::right
                                << "  " << std::setw(24) << std::setprecision(10) << aerr
                                << "  " << std::setw(24) << std::setprecision(10) << rerr
+                               << (from_header[icomp_a] ? "  (at least, from headers)" : "")
                                << "\n";
             }
         }
 
+        if (!json_file.empty()) {
+            bool first = true;
+            json_levels << (json_levels.tellp() > 0 ? ",\n" : "")
+                        << "    {\"level\": " << ilev << ", \"variables\": [";
+            for (int icomp_a = 0; icomp_a < ncomp_a; ++icomp_a) {
+                if (!compared[icomp_a]) continue;
+                json_levels << (first ? "\n" : ",\n")
+                            << "      {\"name\": " << json_string(names_a[icomp_a])
+                            << ", \"abs_error\": " << json_number(aerror[icomp_a])
+                            << ", \"rel_error\": " << json_number(rerror[icomp_a])
+                            << ", \"nan_a\": " << (has_nan_a[icomp_a] ? "true" : "false")
+                            << ", \"nan_b\": " << (has_nan_b[icomp_a] ? "true" : "false")
+                            << ", \"from_header\": " << (from_header[icomp_a] ? "true" : "false")
+                            << ", \"pass\": " << (failed[icomp_a] ? "false" : "true") << "}";
+                first = false;
+            }
+            json_levels << "]}";
+        }
+
+        if (check_bound) {
+            for (int icomp_a = 0; icomp_a < ncomp_a; ++icomp_a) {
+                if (ivar_b[icomp_a] < 0 || !compared[icomp_a] ||
+                    (has_nan_a[icomp_a] && has_nan_b[icomp_a])) {
+                    continue;
+                }
+                if (has_nan_a[icomp_a] || has_nan_b[icomp_a] ||
+                    max_error[icomp_a] > error_bound[icomp_a])
+                {
+                    amrex::Print() << " ERROR: " << names_a[icomp_a]
+                                   << " exceeds the error bound " << error_bound[icomp_a] << "\n";
+                    bound_exceeded = true;
+                }
+            }
+        }
+
         global_error = std::max(global_error,
                                 *(std::max_element(aerror.begin(),
                                                    aerror.end())));
@@ -316,6 +565,26 @@ int main_main()
         for (int icomp_a = 0; icomp_a < ncomp_a; ++icomp_a) {
             any_nans = any_nans || has_nan_a[icomp_a] || has_nan_b[icomp_a];
         }
+
+        if (stopped_early) {
+            amrex::Print() << " stopped after " << nfailures << " failures\n";
+            break;
+        }
+    }
+
+    if (!json_file.empty() && ParallelDescriptor::IOProcessor()) {
+        std::ofstream ofs(json_file);
+        if (!ofs.good()) {
+            amrex::FileOpenFailed(json_file);
+        }
+        ofs << "{\n"
+            << "  \"plotfile_a\": " << json_string(plotfile_a) << ",\n"
+            << "  \"plotfile_b\": " << json_string(plotfile_b) << ",\n"
+            << "  \"norm\": " << norm << ",\n"
+            << "  \"levels\": [\n" << json_levels.str() << "\n  ],\n"
+            << "  \"failures\": " << nfailures << ",\n"
+            << "  \"stopped_early\": " << (stopped_early ? "true" : "false") << "\n"
+            << "}\n";
     }
 
     if (save_var_a >= 0) {
@@ -365,6 +634,22 @@ int main_main()
         if (abort_if_not_all_found) return EXIT_FAILURE;
     }
 
+    if (check_bound) {
+        if (bound_exceeded) {
+            return EXIT_FAILURE;
+        }
+        amrex::Print() << " PLOTFILE AGREE to the error bounds" << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    if (!var_atol.empty() || !var_rtol.empty() || max_failures > 0) {
+        if (nfailures > 0) {
+            return EXIT_FAILURE;
+        }
+        amrex::Print() << " PLOTFILE AGREE to specified tolerances" << std::endl;
+        return EXIT_SUCCESS;
+    }
+
     if (global_error == 0.0 && !any_nans) {
         amrex::Print() << " PLOTFILE AGREE" << std::endl;
         return EXIT_SUCCESS;
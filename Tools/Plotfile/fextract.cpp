@@ -193,12 +193,14 @@ void main_main()
             const iMultiFab mask = makeFineMask(pf.boxArray(ilev), pf.DistributionMap(ilev),
                                                 pf.boxArray(ilev+1), ratio);
             for (int ivar = 0; ivar < var_names.size(); ++ivar) {
-                const MultiFab& mf = pf.get(ilev, var_names[ivar]);
-                for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
-                    const Box& bx = mfi.validbox() & slice_box;
+                // Only the fabs on the line are read.
+                for (int gid : pf.intersections(ilev, slice_box)) {
+                    if (mask.DistributionMap()[gid] != ParallelDescriptor::MyProc()) continue;
+                    const Box& bx = pf.boxArray(ilev)[gid] & slice_box;
                     if (bx.ok()) {
-                        const auto& m = mask.array(mfi);
-                        const auto& fab = mf.array(mfi);
+                        const auto& m = mask[gid].const_array();
+                        const FArrayBox& vfab = pf.getFab(ilev, gid, var_names[ivar]);
+                        const auto& fab = vfab.const_array();
                         const auto lo = amrex::lbound(bx);
                         const auto hi = amrex::ubound(bx);
                         for         (int k = lo.z; k <= hi.z; ++k) {
@@ -223,11 +225,12 @@ void main_main()
             rr *= ratio;
         } else {
             for (int ivar = 0; ivar < var_names.size(); ++ivar) {
-                const MultiFab& mf = pf.get(ilev, var_names[ivar]);
-                for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
-                    const Box& bx = mfi.validbox() & slice_box;
+                for (int gid : pf.intersections(ilev, slice_box)) {
+                    if (pf.DistributionMap(ilev)[gid] != ParallelDescriptor::MyProc()) continue;
+                    const Box& bx = pf.boxArray(ilev)[gid] & slice_box;
                     if (bx.ok()) {
-                        const auto& fab = mf.array(mfi);
+                        const FArrayBox& vfab = pf.getFab(ilev, gid, var_names[ivar]);
+                        const auto& fab = vfab.const_array();
                         const auto lo = amrex::lbound(bx);
                         const auto hi = amrex::ubound(bx);
                         for         (int k = lo.z; k <= hi.z; ++k) {
@@ -199,67 +199,80 @@ void main_main()
     Real gmn = std::numeric_limits<Real>::max();
 
     for (int ilev = 0; ilev <= max_level; ++ilev) {
-        const MultiFab& pltmf = pf.get(ilev, compname);
-        gmx = std::max(gmx, pltmf.max(0));
-        gmn = std::min(gmn, pltmf.min(0));
+        const BoxArray& ba = pf.boxArray(ilev);
+        const DistributionMapping& dm = pf.DistributionMap(ilev);
+
+        // If the header has the extrema, only the fabs on the slices are read.
+        Real lmn, lmx;
+        const bool have_minmax = pf.minMax(ilev, compname, lmn, lmx);
+        if (have_minmax) {
+            gmx = std::max(gmx, lmx);
+            gmn = std::min(gmn, lmn);
+        }
+
+        IntVect rrlev {rr[ilev]};
+        for (int idim = dim; idim < AMREX_SPACEDIM; ++idim) {
+            rrlev[idim] = 1;
+        }
+
+        iMultiFab mask;
         if (ilev < max_level) {
             IntVect ratio{pf.refRatio(ilev)};
             for (int idim = dim; idim < AMREX_SPACEDIM; ++idim) {
                 ratio[idim] = 1;
             }
-            const iMultiFab mask = makeFineMask(pltmf, pf.boxArray(ilev+1), ratio);
-            for (MFIter mfi(pltmf); mfi.isValid(); ++mfi) {
-                const auto& m = mask.array(mfi);
-                const auto& plt = pltmf.array(mfi);
-                const Box& bx = mfi.validbox();
-                IntVect rrlev {rr[ilev]};
-                for (int idim = dim; idim < AMREX_SPACEDIM; ++idim) {
-                    rrlev[idim] = 1;
-                }
-                for (int idir = ndir_begin; idir < ndir_end; ++idir) {
-                    const Box& crsebox = amrex::coarsen(finebox[idir], rrlev);
-                    const Box& ibox = bx & crsebox;
-                    if (ibox.ok()) {
-                        const auto& data = datamf[idir].array(0); // there is only one box
-                        IntVect rrslice = rrlev;
-                        rrslice[idir] = 1;
-                        amrex::For(ibox, [=] AMREX_GPU_DEVICE (int i, int j, int k)
-                        {
-                            if (m(i,j,k) == 0) { // not covered by fine
-                                const Real d = plt(i,j,k);
-                                for         (int koff = 0; koff < rrslice[2]; ++koff) {
-                                    int kk = k*rrlev[2] + koff;
-                                    for     (int joff = 0; joff < rrslice[1]; ++joff) {
-                                        int jj = j*rrlev[1] + joff;
-                                        for (int ioff = 0; ioff < rrslice[0]; ++ioff) {
-                                            int ii = i*rrlev[0] + ioff;
-                                            data(ii,jj,kk) = d;
-                                        }
+            mask = makeFineMask(ba, dm, pf.boxArray(ilev+1), ratio);
+        }
+
+        for (int gid = 0; gid < ba.size(); ++gid) {
+            if (dm[gid] != ParallelDescriptor::MyProc()) continue;
+            const Box& bx = ba[gid];
+            bool on_slice = false;
+            for (int idir = ndir_begin; idir < ndir_end; ++idir) {
+                on_slice = on_slice || bx.intersects(amrex::coarsen(finebox[idir], rrlev));
+            }
+            if (!on_slice && have_minmax) continue;
+
+            const FArrayBox& pltfab = pf.getFab(ilev, gid, compname);
+            if (!have_minmax) {
+                gmx = std::max(gmx, pltfab.max<RunOn::Host>(bx,0));
+                gmn = std::min(gmn, pltfab.min<RunOn::Host>(bx,0));
+            }
+            const auto& plt = pltfab.const_array();
+            const bool has_mask = ilev < max_level;
+            const auto& m = has_mask ? mask[gid].const_array() : Array4<int const>{};
+
+            for (int idir = ndir_begin; idir < ndir_end; ++idir) {
+                const Box& crsebox = amrex::coarsen(finebox[idir], rrlev);
+                const Box& ibox = bx & crsebox;
+                if (ibox.ok()) {
+                    const auto& data = datamf[idir].array(0); // there is only one box
+                    IntVect rrslice = rrlev;
+                    rrslice[idir] = 1;
+                    amrex::LoopOnCpu(ibox, [=] (int i, int j, int k)
+                    {
+                        if (!has_mask || m(i,j,k) == 0) { // not covered by fine
+                            const Real d = plt(i,j,k);
+                            for         (int koff = 0; koff < rrslice[2]; ++koff) {
+                                int kk = k*rrlev[2] + koff;
+                                for     (int joff = 0; joff < rrslice[1]; ++joff) {
+                                    int jj = j*rrlev[1] + joff;
+                                    for (int ioff = 0; ioff < rrslice[0]; ++ioff) {
+                                        int ii = i*rrlev[0] + ioff;
+                                        data(ii,jj,kk) = d;
                                     }
                                 }
                             }
-                        });
-                    }
-                }
-            }
-        } else {
-            for (MFIter mfi(pltmf); mfi.isValid(); ++mfi) {
-                const auto& plt = pltmf.array(mfi);
-                const Box& bx = mfi.validbox();
-                for (int idir = ndir_begin; idir < ndir_end; ++idir) {
-                    const Box& ibox = bx & finebox[idir];
-                    if (ibox.ok()) {
-                        const auto& data = datamf[idir].array(0); // there is only one box
-                        amrex::ParallelFor(ibox, [=] AMREX_GPU_DEVICE (int i, int j, int k)
-                        {
-                            data(i,j,k) = plt(i,j,k);
-                        });
-                    }
+                        }
+                    });
                 }
             }
         }
     }
 
+    ParallelDescriptor::ReduceRealMax(gmx);
+    ParallelDescriptor::ReduceRealMin(gmn);
+
     amrex::Print() << " plotfile variable maximum = " << gmx << "\n"
                    << " plotfile variable minimum = " << gmn << "\n";
 
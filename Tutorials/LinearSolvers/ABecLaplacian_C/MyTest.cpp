@@ -144,6 +144,7 @@ MyTest::solveABecLaplacian ()
         MLABecLaplacian mlabec(geom, grids, dmap, info);
 
         mlabec.setMaxOrder(linop_maxorder);
+        mlabec.setSmoother(smootherType());
 
         // This is a 3d problem with homogeneous Neumann BC
         mlabec.setDomainBC({AMREX_D_DECL(LinOpBCType::Neumann,
@@ -203,6 +204,7 @@ MyTest::solveABecLaplacian ()
             MLABecLaplacian mlabec({geom[ilev]}, {grids[ilev]}, {dmap[ilev]}, info);
             
             mlabec.setMaxOrder(linop_maxorder);
+            mlabec.setSmoother(smootherType());
             
             // This is a 3d problem with homogeneous Neumann BC
             mlabec.setDomainBC({AMREX_D_DECL(LinOpBCType::Neumann,
@@ -286,6 +288,7 @@ MyTest::solveABecLaplacianInhomNeumann ()
         MLABecLaplacian mlabec(geom, grids, dmap, info);
 
         mlabec.setMaxOrder(linop_maxorder);
+        mlabec.setSmoother(smootherType());
 
         // This is a 3d problem with inhomogeneous Neumann BC
         mlabec.setDomainBC({AMREX_D_DECL(LinOpBCType::inhomogNeumann,
@@ -345,6 +348,7 @@ MyTest::solveABecLaplacianInhomNeumann ()
             MLABecLaplacian mlabec({geom[ilev]}, {grids[ilev]}, {dmap[ilev]}, info);
             
             mlabec.setMaxOrder(linop_maxorder);
+            mlabec.setSmoother(smootherType());
             
             // This is a 3d problem with inhomogeneous Neumann BC
             mlabec.setDomainBC({AMREX_D_DECL(LinOpBCType::inhomogNeumann,
@@ -432,6 +436,7 @@ MyTest::readParameters ()
     pp.query("semicoarsening", semicoarsening);
     pp.query("max_coarsening_level", max_coarsening_level);
     pp.query("max_semicoarsening_level", max_semicoarsening_level);
+    pp.query("smoother", smoother);
 
 #ifdef AMREX_USE_HYPRE
     pp.query("use_hypre", use_hypre);
@@ -451,6 +456,20 @@ MyTest::readParameters ()
                                      "use_hypre & use_petsc cannot be both true");
 }
 
+MLSmoother
+MyTest::smootherType () const
+{
+    if (smoother == "line_gs") {
+        return MLSmoother::line_gs;
+    } else if (smoother == "zebra_plane") {
+        return MLSmoother::zebra_plane;
+    } else if (smoother == "chebyshev") {
+        return MLSmoother::chebyshev;
+    } else {
+        return MLSmoother::gsrb;
+    }
+}
+
 void
 MyTest::initData ()
 {